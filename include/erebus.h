@@ -0,0 +1,110 @@
+/**
+ * @file erebus.h
+ * @author UnknownRori (68576836+UnknownRori@users.noreply.github.com)
+ * @brief Stable C ABI of project-erebus, shipped by liberebus.so for FFI consumer
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef UNKNOWNRORI_PROJECT_EREBUS_H
+#define UNKNOWNRORI_PROJECT_EREBUS_H
+
+#include <stddef.h>
+
+// EREBUS_BUILD is defined while building the shared library, EREBUS_STATIC when linking the static one
+#if defined(_WIN32) && defined(EREBUS_BUILD)
+#define EREBUS_API __declspec(dllexport)
+#elif defined(_WIN32) && !defined(EREBUS_STATIC)
+#define EREBUS_API __declspec(dllimport)
+#elif defined(_WIN32)
+#define EREBUS_API
+#else
+#define EREBUS_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    /**
+     * @brief Same value as Rori::Math::ErrorKind, EREBUS_INTERNAL_ERROR is returned when the library fail to allocate
+     *
+     */
+    typedef enum erebus_error
+    {
+        EREBUS_NONE = 0,
+        EREBUS_SYNTAX_ERROR = 1,
+        EREBUS_PARSE_INT_ERROR = 2,
+        EREBUS_INVALID_INTERVAL = 3,
+        EREBUS_UNBOUND_VARIABLE = 4,
+        EREBUS_SHAPE_MISMATCH = 5,
+        EREBUS_IO_ERROR = 6,
+        EREBUS_INTERNAL_ERROR = -1,
+    } erebus_error;
+
+    typedef struct erebus_solver erebus_solver;
+    typedef struct erebus_expression erebus_expression;
+
+    /**
+     * @brief Create solver, must be released with erebus_solver_destroy
+     *
+     * @return erebus_solver*
+     */
+    EREBUS_API erebus_solver *erebus_solver_create(void);
+
+    /**
+     * @brief Release solver, expression compiled by it stay valid
+     *
+     * @param solver
+     */
+    EREBUS_API void erebus_solver_destroy(erebus_solver *solver);
+
+    /**
+     * @brief Compile expression once, identifier listed inside variables is bound by position on evaluation
+     *
+     * @param solver
+     * @param src
+     * @param variables
+     * @param variable_count
+     * @param out must be released with erebus_expression_destroy
+     * @return erebus_error
+     */
+    EREBUS_API erebus_error erebus_compile(erebus_solver *solver, const char *src, const char *const *variables, size_t variable_count, erebus_expression **out);
+
+    /**
+     * @brief Release compiled expression
+     *
+     * @param expression
+     */
+    EREBUS_API void erebus_expression_destroy(erebus_expression *expression);
+
+    /**
+     * @brief Evaluate single row, values hold one value per variable
+     *
+     * @param expression
+     * @param values
+     * @param out
+     * @return erebus_error
+     */
+    EREBUS_API erebus_error erebus_evaluate(const erebus_expression *expression, const double *values, double *out);
+
+    /**
+     * @brief Evaluate count row in one call, columns hold one pointer per variable to count contiguous value
+     *
+     * @param expression
+     * @param columns
+     * @param count
+     * @param out must hold count value
+     * @return erebus_error
+     */
+    EREBUS_API erebus_error erebus_evaluate_batch(const erebus_expression *expression, const double *const *columns, size_t count, double *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
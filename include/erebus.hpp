@@ -15,6 +15,8 @@
 
 #include <vector>
 #include <string>
+#include <memory>
+#include <ostream>
 #include <cmath>
 
 #include "../include/types.hpp"
@@ -44,6 +46,121 @@ namespace Rori::Math
         None,
         SyntaxError,
         ParseIntError,
+        InvalidInterval,
+        UnboundVariable,
+        ShapeMismatch,
+        IoError,
+    };
+
+    /**
+     * @brief Closed range [lower, upper] used for searching roots
+     *
+     */
+    struct Interval
+    {
+        f64 lower;
+        f64 upper;
+    };
+
+    /**
+     * @brief Root found by the solver and how many iteration it take to converge
+     *
+     */
+    struct Root
+    {
+        f64 value;
+        u32 iterations;
+    };
+
+    /**
+     * @brief Execution count and cycle spent on one kind of opcode, is_inclusive is set when the cycle include a nested program (reduction, conditional, array literal)
+     *
+     */
+    struct OpcodeProfile
+    {
+        std::string name;
+        u64 count;
+        u64 cycles;
+        bool is_inclusive;
+    };
+
+    /**
+     * @brief Compiled form of expression, internal representation is hidden
+     *
+     */
+    struct Program;
+
+    /**
+     * @brief Expression that already parsed once and can be evaluated repeatedly
+     *
+     */
+    class Expression
+    {
+    private:
+        std::shared_ptr<const Program> m_program;
+
+    public:
+        Expression() = default;
+        Expression(std::shared_ptr<const Program> program);
+
+        /**
+         * @brief Evaluate compiled expression, values are bound in the same order as compiled variables.
+         * Exact rational arithmetic is only used when the whole expression is integer and rational only and every value is an integer,
+         * otherwise only literal subexpression folded at compile time stay exact, subexpression with variable like qty * 1999 / 100
+         * next to sqrt is evaluated in floating point
+         *
+         * @param __values
+         * @return Result<f64, ErrorKind>
+         */
+        auto evaluate(const std::vector<f64> &__values = {}) const -> Result<f64, ErrorKind>;
+
+        /**
+         * @brief Evaluate compiled expression element-wise, every variable is bound to an array (f32 is double),
+         * array with single element is broadcast to the others
+         *
+         * @param __values
+         * @return Result<std::vector<f32>, ErrorKind>
+         */
+        auto evaluate_array(const std::vector<std::vector<f32>> &__values = {}) const -> Result<std::vector<f32>, ErrorKind>;
+
+        /**
+         * @brief Evaluate compiled expression for __count row at once, __columns hold one pointer per variable
+         * to __count contiguous value and the result is written to __out
+         *
+         * @param __columns
+         * @param __count
+         * @param __out
+         * @return ErrorKind
+         */
+        auto evaluate_batch(const f32 *const *__columns, std::size_t __count, f32 *__out) const -> ErrorKind;
+
+        /**
+         * @brief Print compiled program in Reverse Polish Notation
+         *
+         * @param __os
+         */
+        auto explain(std::ostream &__os) const -> void;
+
+        /**
+         * @brief Record per opcode cost of one every __every evaluation, 0 disable it
+         *
+         * @param __every
+         */
+        auto set_sampling(u32 __every) const -> void;
+
+        /**
+         * @brief Get per opcode cost recorded so far, most expensive first
+         *
+         * @return std::vector<OpcodeProfile>
+         */
+        auto get_profile() const -> std::vector<OpcodeProfile>;
+
+        /**
+         * @brief Get the compiled form
+         *
+         * @return const std::shared_ptr<const Program>&
+         */
+        auto get_program() const -> const std::shared_ptr<const Program> &;
     };
 
     class MathSolver
@@ -52,12 +169,50 @@ namespace Rori::Math
         MathSolver() = default;
 
         /**
-         * @brief Evaluate Math Expressions
+         * @brief Evaluate Math Expressions, exact rational arithmetic follow the same rule as Expression::evaluate
          *
          * @param __src
          * @return Result<f64, ErrorKind>
          */
         auto evaluate(const std::string &__src) -> Result<f64, ErrorKind>;
+
+        /**
+         * @brief Evaluate Math Expressions that may contain array literal like [1, 2, 3]
+         *
+         * @param __src
+         * @return Result<std::vector<f32>, ErrorKind>
+         */
+        auto evaluate_array(const std::string &__src) -> Result<std::vector<f32>, ErrorKind>;
+
+        /**
+         * @brief Parse Math Expressions once, identifier inside __variables are treated as variable
+         *
+         * @param __src
+         * @param __variables
+         * @return Result<Expression, ErrorKind>
+         */
+        auto compile(const std::string &__src, const std::vector<std::string> &__variables = {}) -> Result<Expression, ErrorKind>;
+
+        /**
+         * @brief Find every x inside __interval where f(x) = c, __src can be written as "f(x) = c" or "f(x)"
+         *
+         * @param __src
+         * @param __variable
+         * @param __interval
+         * @return Result<std::vector<Root>, ErrorKind>
+         */
+        auto solve(const std::string &__src, const std::string &__variable, Interval __interval) -> Result<std::vector<Root>, ErrorKind>;
+
+        /**
+         * @brief Evaluate every "name=expression" formula for each row of CSV file, header name is the variable,
+         * every row is written to __out with the formula result appended as new column
+         *
+         * @param __path
+         * @param __formulas
+         * @param __out
+         * @return ErrorKind
+         */
+        auto evaluate_csv(const std::string &__path, const std::vector<std::string> &__formulas, std::ostream &__out) -> ErrorKind;
     };
 }
 
@@ -15,6 +15,7 @@
 #include <iostream>
 #include <vector>
 #include <stack>
+#include <atomic>
 #include <functional>
 #include "./erebus.hpp"
 #include "./types.hpp"
@@ -34,7 +35,21 @@ enum TokenType
     PowerOperator,
     OpenParenthesis,
     CloseParenthesis,
-    Function
+    Function,
+    Variable,
+    Reduction,
+    ArrayLiteral,
+    Less,
+    LessEqual,
+    Greater,
+    GreaterEqual,
+    Equal,
+    NotEqual,
+    And,
+    Or,
+    Conditional,
+    JumpIfFalse,
+    JumpIfTrue,
 };
 
 /**
@@ -51,6 +66,36 @@ enum FunctionType
     Sqrt,
     Log,
     Floor,
+    ArraySum,
+    ArrayMean,
+    ArrayMin,
+    ArrayMax,
+};
+
+/**
+ * @brief Define Type of Reduction, reduction bind a variable over a range
+ */
+enum ReductionType
+{
+    Sum,
+    Product,
+    Integral,
+};
+
+/**
+ * @brief 128 bit integer for exact arithmetic, kept out of the public header since not every compiler has it
+ *
+ */
+__extension__ typedef __int128 i128;
+
+/**
+ * @brief Exact rational number kept reduced with positive denominator, zero denominator mean the value is not exact
+ *
+ */
+struct Rational
+{
+    i128 numerator;
+    i128 denominator;
 };
 
 /**
@@ -64,11 +109,14 @@ private:
     FunctionType m_func_type;
     i32 m_precedence;
     f64 m_value;
+    u32 m_slot;
     bool m_is_left_associativity;
+    Rational m_exact = {0, 0};
 
 public:
     Token() = default;
-    Token(TokenType type, f64 value);
+    Token(TokenType type, f64 value, Rational exact);
+    Token(TokenType type, u32 slot);
     Token(TokenType type);
     Token(TokenType type, FunctionType func_type);
     Token(TokenType type, i32 precedence, bool is_left_associativity);
@@ -76,12 +124,96 @@ public:
     const TokenType &get_token() const;
     const FunctionType &get_function_type() const;
     const f64 &get_value() const;
+    const u32 &get_slot() const;
+    const Rational &get_exact() const;
     const i32 &get_precedence() const;
     const bool &is_left_associative() const;
 
     friend std::ostream &operator<<(std::ostream &os, const Token &token);
 };
 
+struct ReductionProgram;
+struct ConditionalProgram;
+
+/**
+ * @brief Opcode is the token type, function and reduction get their own range so every kind is counted separately
+ *
+ */
+constexpr std::size_t OPCODE_FUNCTION_OFFSET = 32;
+constexpr std::size_t OPCODE_REDUCTION_OFFSET = 48;
+constexpr std::size_t OPCODE_COUNT = 64;
+
+/**
+ * @brief Per opcode execution count and cycle, shared by a compiled program and every program nested inside it
+ *
+ */
+struct ProfileCounters
+{
+    std::atomic<u32> sample_every{0};
+    std::atomic<u64> tick{0};
+    std::atomic<u64> count[OPCODE_COUNT]{};
+    std::atomic<u64> cycles[OPCODE_COUNT]{};
+
+    auto should_sample() -> bool;
+};
+
+/**
+ * @brief Compiled expression, code is stored in Reverse Polish Notation
+ *
+ */
+struct Rori::Math::Program
+{
+    std::vector<Token> code;
+    std::vector<std::string> variables;
+    std::size_t stack_size;
+    std::vector<ReductionProgram> reductions;
+    std::vector<std::vector<Rori::Math::Program>> arrays;
+    std::vector<ConditionalProgram> conditionals;
+    std::size_t length;
+    std::shared_ptr<ProfileCounters> profile;
+    bool is_exact = false;
+};
+
+/**
+ * @brief sum(i, lower, upper, body), prod(...) and integrate(x, lower, upper, body),
+ * body is compiled once with the bound variable appended as the last variable
+ *
+ */
+struct ReductionProgram
+{
+    ReductionType type;
+    Rori::Math::Program lower;
+    Rori::Math::Program upper;
+    Rori::Math::Program body;
+};
+
+/**
+ * @brief if(condition, then, otherwise), every branch is compiled on its own so scalar evaluation only run the taken one
+ *
+ */
+struct ConditionalProgram
+{
+    Rori::Math::Program condition;
+    Rori::Math::Program then;
+    Rori::Math::Program otherwise;
+};
+
+/**
+ * @brief Amount of lane evaluated at once by execute_block
+ *
+ */
+constexpr std::size_t BLOCK_SIZE = 64;
+
+/**
+ * @brief Dual number for forward mode differentiation, derivative is carried along the value
+ *
+ */
+struct Dual
+{
+    f64 value;
+    f64 derivative;
+};
+
 /**
  * @brief Helper function for popping the stack
  *
@@ -92,10 +224,125 @@ public:
 template <typename T>
 static inline auto pop(std::stack<T> &stack) -> T;
 
+/**
+ * @brief Check if __name can be used as variable name, [A-Za-z_][A-Za-z0-9_]*
+ *
+ */
+static inline auto is_identifier(const std::string &__name) -> bool;
+
 static inline auto parse_int(const std::string &__src) -> Result<f64, Rori::Math::ErrorKind>;
-static auto parse(const std::vector<Token> &__src) -> Result<std::stack<Token>, Rori::Math::ErrorKind>;
-static auto tokenize(const std::string &__src) -> Result<std::vector<Token>, Rori::Math::ErrorKind>;
-static auto calculate(std::stack<Token> &__src) -> Rori::Math::ErrorKind;
+static auto parse_rational(const std::string &__src) -> Rational;
+static auto parse(const std::vector<Token> &__src) -> Result<std::vector<Token>, Rori::Math::ErrorKind>;
+static auto tokenize(const std::string &__src, Rori::Math::Program &__program) -> Result<std::vector<Token>, Rori::Math::ErrorKind>;
+static auto find_closing(const std::string &__src, std::size_t __open) -> std::size_t;
+static auto split_arguments(const std::string &__src) -> std::vector<std::string>;
+static auto compile_reduction(const std::string &__name, const std::string &__args, const std::vector<std::string> &__variables) -> Result<ReductionProgram, Rori::Math::ErrorKind>;
+static auto compile_conditional(const std::string &__args, const std::vector<std::string> &__variables) -> Result<ConditionalProgram, Rori::Math::ErrorKind>;
+static auto compile_program(const std::string &__src, const std::vector<std::string> &__variables) -> Result<Rori::Math::Program, Rori::Math::ErrorKind>;
+static auto insert_jumps(const std::vector<Token> &__code) -> std::vector<Token>;
+static auto fold_constants(const std::vector<Token> &__code) -> std::vector<Token>;
+
+/**
+ * @brief Whole program check, a program with a single inexact opcode like sqrt run every subexpression in floating point
+ *
+ */
+static auto is_exact_program(const Rori::Math::Program &__program) -> bool;
+
+/**
+ * @brief Apply binary operator in exact arithmetic, return zero denominator when it overflow or the result isn't rational
+ *
+ */
+static auto apply_exact(TokenType __op, Rational __lhs, Rational __rhs) -> Rational;
+
+/**
+ * @brief Run compiled code in exact arithmetic, every variable must hold an integer,
+ * return zero denominator when it need floating point instead
+ *
+ */
+static auto execute_exact(const Rori::Math::Program &__program, const f64 *__values) -> Rational;
+
+/**
+ * @brief Evaluate scalar program, try exact arithmetic first when the program allow it,
+ * the sampling decision is rolled once for both attempt
+ *
+ */
+static auto evaluate_program(const Rori::Math::Program &__program, const f64 *__values) -> f64;
+
+/**
+ * @brief Run compiled code, T is either f64 or Dual
+ *
+ */
+template <typename T>
+static auto execute(const Rori::Math::Program &__program, const T *__values) -> T;
+
+/**
+ * @brief Run compiled code where every variable is bound to an array, length 1 array is broadcast
+ *
+ */
+template <typename T>
+static auto execute_array(const Rori::Math::Program &__program, const std::vector<T> *__values) -> Result<std::vector<T>, Rori::Math::ErrorKind>;
+
+/**
+ * @brief Run compiled code over __count lane at once, __values hold pointer to __count value of every variable,
+ * __stack must hold stack_size * BLOCK_SIZE and the result is stored on the first __count element
+ *
+ */
+template <typename T>
+static auto execute_block(const Rori::Math::Program &__program, const T *const *__values, std::size_t __count, T *__stack) -> void;
+
+/**
+ * @brief Evaluate sum, product or integral with the outer variable bound to __values
+ *
+ */
+template <typename T>
+static auto reduce(const ReductionProgram &__reduction, const T *__values) -> T;
+
+/**
+ * @brief 15 point Gauss-Kronrod rule evaluated as one block, return the estimate and the error
+ *
+ */
+template <typename T>
+static auto gauss_kronrod(const Rori::Math::Program &__body, std::vector<T> &__lanes, f64 __lower, f64 __upper) -> std::tuple<T, f64>;
+
+/**
+ * @brief Adaptive Gauss-Kronrod quadrature of single panel, bisect until the error fit __tolerance
+ * or __budget subdivision has been spent
+ *
+ */
+template <typename T>
+static auto integrate_panel(const Rori::Math::Program &__body, std::vector<T> &__lanes, f64 __lower, f64 __upper, f64 __tolerance, u32 __depth, u32 &__budget) -> T;
+
+/**
+ * @brief Print compiled code one opcode per line, nested program is indented under its owner
+ *
+ */
+static auto explain_program(const Rori::Math::Program &__program, std::ostream &__os, std::size_t __indent) -> void;
+
+/**
+ * @brief Share __profile with __program and every program nested inside it
+ *
+ */
+static auto attach_profile(Rori::Math::Program &__program, const std::shared_ptr<ProfileCounters> &__profile) -> void;
+
+/**
+ * @brief Opcode index and name used by the profiler
+ *
+ */
+static auto opcode_of(const Rori::Math::Program &__program, const Token &__token) -> std::size_t;
+static auto opcode_name(std::size_t __opcode) -> std::string;
+
+/**
+ * @brief Opcode that run nested program, its cycle already include the opcode of that program
+ *
+ */
+static auto is_inclusive_opcode(std::size_t __opcode) -> bool;
+
+
+/**
+ * @brief Find roots inside [__lower, __upper] by sampling and refining sign changes with safeguarded Newton
+ *
+ */
+static auto find_roots(const Rori::Math::Program &__program, f64 __lower, f64 __upper, std::size_t __segment_start, std::size_t __segment_end, std::size_t __segment_count) -> std::vector<Rori::Math::Root>;
 
 /**
  * @brief A algorithm helper function
@@ -23,26 +23,6 @@
         continue;                                          \
     }
 
-/**
- * @brief Resolve Function Token and push it to stack
- */
-#define PUSH_RESOLVED_FUNCTION_TOKEN_STACK(STACK, OP, IS_EQUAL, VALUE) \
-    if (OP.get_function_type() == IS_EQUAL)                            \
-    {                                                                  \
-        STACK.push(CREATE_NUMBER_TOKEN(VALUE));                        \
-        return Rori::Math::ErrorKind::None;                            \
-    }
-
-/**
- * @brief Resolve Operand and push it to stack
- */
-#define PUSH_RESOLVE_OP_TOKEN_STACK(STACK, OP, IS_EQUAL, VALUE) \
-    if (OP.get_token() == IS_EQUAL)                             \
-    {                                                           \
-        STACK.push(CREATE_NUMBER_TOKEN(VALUE));                 \
-        return Rori::Math::ErrorKind::None;                     \
-    }
-
 #define IF_TRUE_LBITSHIFT_OS(OSTREAM, CONDITION, VALUE) \
     if (CONDITION)                                      \
     {                                                   \
@@ -51,13 +31,28 @@
     }
 
 /**
- * @brief Check if the passed stack is empty, if true it will return IF_TRUE
+ * @brief Check if there is enough operand left on compiled code, if not it will return SyntaxError
  */
-#define CHECK_IF_EMPTY(STACK, IF_TRUE) \
-    if (STACK.empty())                 \
-        return IF_TRUE;
+#define CHECK_OPERAND_COUNT(DEPTH, NEEDED, PROGRAM) \
+    if (DEPTH < NEEDED)                             \
+        return {PROGRAM, Rori::Math::ErrorKind::SyntaxError};
 
-#define CREATE_NUMBER_TOKEN(VAL) Token(TokenType::Number, VAL)
+/**
+ * @brief Apply FUNC on every lane of OP, loop is kept simple so compiler can vectorize it
+ */
+#define BLOCK_APPLY_UNARY(OP, COUNT, FUNC)  \
+    for (std::size_t k = 0; k < COUNT; k++) \
+        OP[k] = FUNC(OP[k]);
+
+/**
+ * @brief Store EXPR into LHS for every lane, EXPR can refer to the lane index as k
+ */
+#define BLOCK_APPLY_BINARY(LHS, RHS, COUNT, EXPR) \
+    for (std::size_t k = 0; k < COUNT; k++)       \
+        LHS[k] = EXPR;
+
+#define CREATE_NUMBER_TOKEN(VAL, EXACT) Token(TokenType::Number, VAL, EXACT)
+#define CREATE_VARIABLE_TOKEN(SLOT) Token(TokenType::Variable, static_cast<u32>(SLOT))
 
 #define PARSE_INT_FROM_STR(SRC, START, I)                                 \
     {                                                                     \
@@ -70,4 +65,16 @@
         }                                                                 \
     }
 
+/**
+ * @brief Push parsed negative number, lone '-' is turned into "-1 *" so "-x" or "-(...)" is negation
+ */
+#define PUSH_NEGATED_STR(VEC, SRC, START, I)            \
+    if (I - START == 1)                                \
+    {                                                  \
+        VEC.push_back("-1");                           \
+        VEC.push_back("*");                            \
+    }                                                  \
+    else                                               \
+        VEC.push_back(SRC.substr(START, I - START));
+
 #endif
\ No newline at end of file
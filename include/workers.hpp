@@ -0,0 +1,80 @@
+/**
+ * @file workers.hpp
+ * @author UnknownRori (68576836+UnknownRori@users.noreply.github.com)
+ * @brief Worker thread helper shared by the library source, not for external use
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#pragma once
+#ifndef UNKNOWNRORI_WORKERS_PROJECT_EREBUS_HPP
+#define UNKNOWNRORI_WORKERS_PROJECT_EREBUS_HPP
+
+#include <algorithm>
+#include <functional>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Set inside worker thread and per lane loop, parallel section nested in them run on the calling thread
+ * so thread is only spawned at the top level
+ *
+ */
+inline thread_local bool is_serial = false;
+
+/**
+ * @brief Force nested parallel section to run serially until the end of the scope
+ *
+ */
+class SerialScope
+{
+private:
+    bool m_previous;
+
+public:
+    SerialScope(bool is_serial_scope = true) : m_previous(is_serial) { is_serial = is_serial || is_serial_scope; }
+    ~SerialScope() { is_serial = this->m_previous; }
+
+    SerialScope(const SerialScope &) = delete;
+    SerialScope &operator=(const SerialScope &) = delete;
+};
+
+/**
+ * @brief Amount of worker thread worth spawning for __jobs independent job, always 1 inside a serial section
+ *
+ */
+inline auto worker_count(std::size_t __jobs) -> std::size_t
+{
+    if (is_serial)
+        return 1;
+
+    return std::clamp<std::size_t>(std::thread::hardware_concurrency(), 1, std::max<std::size_t>(__jobs, 1));
+}
+
+/**
+ * @brief Run __job for every worker index and wait for all of them, single worker run on the calling thread
+ *
+ */
+inline auto run_workers(std::size_t __workers_size, const std::function<void(std::size_t)> &__job) -> void
+{
+    if (__workers_size == 1)
+    {
+        __job(0);
+        return;
+    }
+
+    std::vector<std::thread> workers;
+    for (std::size_t worker = 0; worker < __workers_size; worker++)
+        workers.emplace_back([&__job, worker]()
+                             {
+                                 SerialScope serial;
+                                 __job(worker); });
+
+    for (auto &worker : workers)
+        worker.join();
+}
+
+#endif
@@ -11,6 +11,9 @@
 
 #include <iostream>
 #include <csignal>
+#include <string>
+#include <chrono>
+#include <limits>
 #include "./include/erebus.hpp"
 
 #ifdef _WIN32
@@ -22,6 +25,10 @@
 #define EXIT_SUCCESS 0
 
 auto signal_handler(int) -> void;
+auto print_error(Rori::Math::ErrorKind, std::ostream & = std::cout) -> void;
+auto solve(char **) -> i32;
+auto explain(i32, char **) -> i32;
+auto csv(i32, char **) -> i32;
 
 auto main(i32 argc, char **argv) -> i32
 {
@@ -32,11 +39,23 @@ auto main(i32 argc, char **argv) -> i32
     }
 #endif
 
+    if (argc == 6 && std::string(argv[1]) == "--solve")
+        return solve(argv + 2);
+
+    if (argc >= 3 && std::string(argv[1]) == "--explain")
+        return explain(argc - 2, argv + 2);
+
+    if (argc >= 5 && std::string(argv[1]) == "--csv")
+        return csv(argc - 2, argv + 2);
+
     signal(SIGINT, signal_handler);
 
     std::cout << "===== Project Ἔρεβος - Simple Math Solver =====\n"
               << "Usage : Write math expression, invalid keyword will trigger Syntax Error!\n\n";
 
+    // Exact integer result is only visible with every digit of f64
+    std::cout.precision(std::numeric_limits<f64>::digits10);
+
     auto solver = Rori::Math::MathSolver();
     loop
     {
@@ -53,10 +72,22 @@ auto main(i32 argc, char **argv) -> i32
 
         auto [result, err] = solver.evaluate(buffer);
 
-        if (err == Rori::Math::ErrorKind::SyntaxError)
-            std::cout << "Error: Syntax Error\n\n";
-        else if (err == Rori::Math::ErrorKind::ParseIntError)
-            std::cout << "Error: Failed to parse integer value\n\n";
+        if (err == Rori::Math::ErrorKind::ShapeMismatch)
+        {
+            auto [array, err2] = solver.evaluate_array(buffer);
+            if (err2 != Rori::Math::ErrorKind::None)
+            {
+                print_error(err2);
+                continue;
+            }
+
+            std::cout << "Result\t: [";
+            for (std::size_t i = 0; i < array.size(); i++)
+                std::cout << (i == 0 ? "" : ", ") << array[i];
+            std::cout << "]\n\n";
+        }
+        else if (err != Rori::Math::ErrorKind::None)
+            print_error(err);
         else
             std::cout << "Result\t: " << result << "\n\n";
     }
@@ -72,3 +103,176 @@ auto signal_handler(int __signum) -> void
 
     exit(__signum);
 }
+
+auto print_error(Rori::Math::ErrorKind __err, std::ostream &__os) -> void
+{
+    if (__err == Rori::Math::ErrorKind::SyntaxError)
+        __os << "Error: Syntax Error\n\n";
+    else if (__err == Rori::Math::ErrorKind::ParseIntError)
+        __os << "Error: Failed to parse integer value\n\n";
+    else if (__err == Rori::Math::ErrorKind::InvalidInterval)
+        __os << "Error: Lower bound must be less than upper bound\n\n";
+    else if (__err == Rori::Math::ErrorKind::UnboundVariable)
+        __os << "Error: Variable is not bound\n\n";
+    else if (__err == Rori::Math::ErrorKind::ShapeMismatch)
+        __os << "Error: Array length doesn't match\n\n";
+    else if (__err == Rori::Math::ErrorKind::IoError)
+        __os << "Error: Failed to read file\n\n";
+}
+
+/**
+ * @brief erebus --solve "<expression>" <variable> <lower> <upper>
+ */
+auto solve(char **__args) -> i32
+{
+    auto solver = Rori::Math::MathSolver();
+
+    Rori::Math::Interval interval;
+    try
+    {
+        interval = {std::stold(__args[2]), std::stold(__args[3])};
+    }
+    catch (std::exception &err)
+    {
+        print_error(Rori::Math::ErrorKind::ParseIntError, std::cerr);
+        return 1;
+    }
+
+    auto [roots, err] = solver.solve(__args[0], __args[1], interval);
+
+    if (err != Rori::Math::ErrorKind::None)
+    {
+        print_error(err, std::cerr);
+        return 1;
+    }
+
+    if (roots.empty())
+        std::cout << "No root found\n";
+
+    std::cout.precision(15);
+    for (auto &root : roots)
+        std::cout << __args[1] << "\t= " << root.value << "\t(" << root.iterations << " iterations)\n";
+
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief erebus --explain "<expression>" [<variable>=<value> ...]
+ */
+auto explain(i32 __count, char **__args) -> i32
+{
+    constexpr u32 SAMPLE_EVERY = 8;
+    constexpr u32 MAX_EVALUATION = 100000;
+    constexpr auto TIME_BUDGET = std::chrono::milliseconds(500);
+
+    const char *src = __args[0];
+    std::vector<std::string> variables;
+    std::vector<f64> values;
+    for (i32 i = 1; i < __count; i++)
+    {
+        std::string binding = __args[i];
+        std::size_t equal_sign = binding.find('=');
+        if (equal_sign == std::string::npos)
+        {
+            print_error(Rori::Math::ErrorKind::SyntaxError, std::cerr);
+            return 1;
+        }
+
+        try
+        {
+            values.push_back(std::stold(binding.substr(equal_sign + 1)));
+        }
+        catch (std::exception &err)
+        {
+            print_error(Rori::Math::ErrorKind::ParseIntError, std::cerr);
+            return 1;
+        }
+
+        variables.push_back(binding.substr(0, equal_sign));
+    }
+
+    auto solver = Rori::Math::MathSolver();
+    auto [expression, err] = solver.compile(src, variables);
+
+    if (err != Rori::Math::ErrorKind::None)
+    {
+        print_error(err, std::cerr);
+        return 1;
+    }
+
+    std::cout << "Program\t: " << src << "\n";
+    expression.explain(std::cout);
+
+    // Keep evaluating until the budget run out so cheap expression still get enough sample
+    expression.set_sampling(SAMPLE_EVERY);
+    auto start = std::chrono::steady_clock::now();
+    u32 evaluation = 0;
+    f64 result = 0;
+    while (evaluation < MAX_EVALUATION && std::chrono::steady_clock::now() - start < TIME_BUDGET)
+    {
+        auto [value, err2] = expression.evaluate(values);
+        if (err2 != Rori::Math::ErrorKind::None)
+        {
+            print_error(err2, std::cerr);
+            return 1;
+        }
+
+        result = value;
+        evaluation++;
+    }
+
+    auto profile = expression.get_profile();
+    // Inclusive opcode already contain the opcode of its nested program, counting it again would skew the share
+    u64 total = 0;
+    for (auto &opcode : profile)
+        if (!opcode.is_inclusive)
+            total += opcode.cycles;
+
+    std::cout << "\nResult\t: " << result << "\n"
+              << "Profile\t: " << evaluation << " evaluations, 1 every " << SAMPLE_EVERY << " sampled\n"
+              << "opcode\tcount\tcycles\tcycles/op\tshare\n";
+
+    for (auto &opcode : profile)
+    {
+        std::cout << opcode.name << "\t" << opcode.count << "\t" << opcode.cycles << "\t"
+                  << opcode.cycles / opcode.count << "\t\t";
+
+        if (opcode.is_inclusive)
+            std::cout << "inclusive\n";
+        else
+            std::cout << (total == 0 ? 0 : 100.0 * opcode.cycles / total) << "%\n";
+    }
+
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief erebus --csv <file> --expr "<name>=<expression>" ...
+ */
+auto csv(i32 __count, char **__args) -> i32
+{
+    std::vector<std::string> formulas;
+    for (i32 i = 1; i < __count; i += 2)
+    {
+        if (std::string(__args[i]) != "--expr" || i + 1 >= __count)
+        {
+            print_error(Rori::Math::ErrorKind::SyntaxError, std::cerr);
+            return 1;
+        }
+
+        formulas.push_back(__args[i + 1]);
+    }
+
+    // Output can be as large as the input, skip syncing with C stdio
+    std::ios::sync_with_stdio(false);
+
+    auto solver = Rori::Math::MathSolver();
+    auto err = solver.evaluate_csv(__args[0], formulas, std::cout);
+    if (err != Rori::Math::ErrorKind::None)
+    {
+        print_error(err, std::cerr);
+        return 1;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -13,174 +13,1959 @@
 #include <functional>
 #include <stack>
 #include <tuple>
+#include <thread>
+#include <chrono>
+#include <algorithm>
 #include "../include/erebus_internal.hpp"
 #include "../include/erebus.hpp"
 #include "../include/macros.hpp"
+#include "../include/workers.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
 
 // Functions and Classes Definition
 
-static inline auto parse_int(const std::string &__src) -> Result<f64, Rori::Math::ErrorKind>
-{
-    try
-    {
-        f64 result = std::stof(__src);
-        return {result, Rori::Math::ErrorKind::None};
+static inline auto is_identifier(const std::string &__name) -> bool
+{
+    return !__name.empty() && (std::isalpha(__name[0]) || __name[0] == '_') &&
+           std::all_of(__name.begin(), __name.end(), [](char c)
+                       { return std::isalnum(c) || c == '_'; });
+}
+
+static inline auto parse_int(const std::string &__src) -> Result<f64, Rori::Math::ErrorKind>
+{
+    try
+    {
+        // Only whole token is a number, stold alone would read "inflation" as inf
+        std::size_t size;
+        f64 result = std::stold(__src, &size);
+        if (size != __src.size())
+            return {-1, Rori::Math::ErrorKind::ParseIntError};
+
+        return {result, Rori::Math::ErrorKind::None};
+    }
+    catch (std::invalid_argument &err)
+    {
+        return {-1, Rori::Math::ErrorKind::ParseIntError};
+    }
+    catch (std::out_of_range &err)
+    {
+        return {-1, Rori::Math::ErrorKind::ParseIntError};
+    }
+}
+
+template <typename T>
+static inline auto pop(std::stack<T> &stack) -> T
+{
+    auto temp = stack.top();
+    stack.pop();
+    return temp;
+}
+
+auto Rori::Math::input(std::string &__dst, const char *__msg) -> void
+{
+    std::cout << __msg;
+    std::getline(std::cin, __dst);
+}
+
+auto Rori::Math::print_help() -> void
+{
+    std::cout << "\nSupported Operand\t: '+', '-', '*', '/', '^', '%'\n"
+              << "Supported Function\t: 'sin', 'cos', 'tan', 'acos', 'asin', 'atan', 'sqrt', 'log', 'floor'\n"
+              << "Supported Reduction\t: 'sum(i, a, b, expr)', 'prod(i, a, b, expr)', 'integrate(x, a, b, expr)'\n"
+              << "Supported Array\t: '[1, 2, 3]', 'sum', 'mean', 'min', 'max'\n"
+              << "Supported Condition\t: '<', '<=', '>', '>=', '==', '!=', 'and', 'or', 'if(cond, a, b)'\n"
+              << "example\t: sin(4*(2+8)^2) it will resulted -0.8509193596\n"
+              << "Solve equation\t: erebus --solve \"x^2 = 2\" x -10 10\n"
+              << "Explain\t: erebus --explain \"sum(i, 1, 100, sin(i)^2)\"\n"
+              << "CSV\t: erebus --csv data.csv --expr \"total=price*qty\" ...\n\n";
+}
+
+template <typename _InputIterator, typename F>
+static inline auto transform(_InputIterator start, _InputIterator end, _InputIterator dst, std::function<void(F)> lambda) -> void
+{
+    for (; start != end; start++)
+    {
+        lambda(*start);
+    }
+}
+
+// Token Class
+
+Token::Token(TokenType type, f64 value, Rational exact)
+    : m_type(type), m_value(value), m_exact(exact) {}
+
+Token::Token(TokenType type, u32 slot)
+    : m_type(type), m_slot(slot) {}
+
+Token::Token(TokenType type) : m_type(type) {}
+
+Token::Token(TokenType type, FunctionType func_type)
+    : m_type(type), m_func_type(func_type), m_precedence(4), m_is_left_associativity(false) {}
+
+Token::Token(TokenType type, i32 precedence, bool is_left_associativity)
+    : m_type(type), m_precedence(precedence), m_is_left_associativity(is_left_associativity) {}
+
+const TokenType &Token::get_token() const { return this->m_type; }
+const FunctionType &Token::get_function_type() const { return this->m_func_type; }
+const f64 &Token::get_value() const { return this->m_value; }
+const u32 &Token::get_slot() const { return this->m_slot; }
+const Rational &Token::get_exact() const { return this->m_exact; }
+const i32 &Token::get_precedence() const { return this->m_precedence; }
+const bool &Token::is_left_associative() const { return this->m_is_left_associativity; }
+
+std::ostream &operator<<(std::ostream &os, const Token &token)
+{
+    if (token.m_type == TokenType::Function)
+    {
+        IF_TRUE_LBITSHIFT_OS(os, token.m_func_type == FunctionType::Sin, "sin");
+        IF_TRUE_LBITSHIFT_OS(os, token.m_func_type == FunctionType::Cos, "cos");
+        IF_TRUE_LBITSHIFT_OS(os, token.m_func_type == FunctionType::Tan, "tan");
+        IF_TRUE_LBITSHIFT_OS(os, token.m_func_type == FunctionType::Asin, "Asin");
+        IF_TRUE_LBITSHIFT_OS(os, token.m_func_type == FunctionType::Acos, "Acos");
+        IF_TRUE_LBITSHIFT_OS(os, token.m_func_type == FunctionType::Atan, "Atan");
+        IF_TRUE_LBITSHIFT_OS(os, token.m_func_type == FunctionType::Sqrt, "Sqrt");
+        IF_TRUE_LBITSHIFT_OS(os, token.m_func_type == FunctionType::Log, "Log");
+        IF_TRUE_LBITSHIFT_OS(os, token.m_func_type == FunctionType::Floor, "Floor");
+        IF_TRUE_LBITSHIFT_OS(os, token.m_func_type == FunctionType::ArraySum, "Sum");
+        IF_TRUE_LBITSHIFT_OS(os, token.m_func_type == FunctionType::ArrayMean, "Mean");
+        IF_TRUE_LBITSHIFT_OS(os, token.m_func_type == FunctionType::ArrayMin, "Min");
+        IF_TRUE_LBITSHIFT_OS(os, token.m_func_type == FunctionType::ArrayMax, "Max");
+    }
+
+    IF_TRUE_LBITSHIFT_OS(os, token.m_type == TokenType::Number, token.m_value);
+    IF_TRUE_LBITSHIFT_OS(os, token.m_type == TokenType::Plus, "+");
+    IF_TRUE_LBITSHIFT_OS(os, token.m_type == TokenType::Subtract, "-");
+    IF_TRUE_LBITSHIFT_OS(os, token.m_type == TokenType::Multiply, "*");
+    IF_TRUE_LBITSHIFT_OS(os, token.m_type == TokenType::Divide, "/");
+    IF_TRUE_LBITSHIFT_OS(os, token.m_type == TokenType::PowerOperator, "^");
+    IF_TRUE_LBITSHIFT_OS(os, token.m_type == TokenType::OpenParenthesis, "(");
+    IF_TRUE_LBITSHIFT_OS(os, token.m_type == TokenType::CloseParenthesis, ")");
+    IF_TRUE_LBITSHIFT_OS(os, token.m_type == TokenType::Variable, "$" << token.m_slot);
+    IF_TRUE_LBITSHIFT_OS(os, token.m_type == TokenType::ArrayLiteral, "[" << token.m_slot << "]");
+    IF_TRUE_LBITSHIFT_OS(os, token.m_type == TokenType::Less, "<");
+    IF_TRUE_LBITSHIFT_OS(os, token.m_type == TokenType::LessEqual, "<=");
+    IF_TRUE_LBITSHIFT_OS(os, token.m_type == TokenType::Greater, ">");
+    IF_TRUE_LBITSHIFT_OS(os, token.m_type == TokenType::GreaterEqual, ">=");
+    IF_TRUE_LBITSHIFT_OS(os, token.m_type == TokenType::Equal, "==");
+    IF_TRUE_LBITSHIFT_OS(os, token.m_type == TokenType::NotEqual, "!=");
+    IF_TRUE_LBITSHIFT_OS(os, token.m_type == TokenType::And, "and");
+    IF_TRUE_LBITSHIFT_OS(os, token.m_type == TokenType::Or, "or");
+    IF_TRUE_LBITSHIFT_OS(os, token.m_type == TokenType::Conditional, "if" << token.m_slot);
+
+    return os;
+}
+
+// Dual Number
+
+static inline auto operator+(Dual a, Dual b) -> Dual { return {a.value + b.value, a.derivative + b.derivative}; }
+static inline auto operator-(Dual a, Dual b) -> Dual { return {a.value - b.value, a.derivative - b.derivative}; }
+static inline auto operator*(Dual a, Dual b) -> Dual { return {a.value * b.value, a.derivative * b.value + a.value * b.derivative}; }
+static inline auto operator/(Dual a, Dual b) -> Dual
+{
+    return {a.value / b.value, (a.derivative * b.value - a.value * b.derivative) / (b.value * b.value)};
+}
+
+static inline auto sin(Dual a) -> Dual { return {std::sin(a.value), std::cos(a.value) * a.derivative}; }
+static inline auto cos(Dual a) -> Dual { return {std::cos(a.value), -std::sin(a.value) * a.derivative}; }
+static inline auto tan(Dual a) -> Dual
+{
+    f64 sec = 1 / std::cos(a.value);
+    return {std::tan(a.value), sec * sec * a.derivative};
+}
+static inline auto asin(Dual a) -> Dual { return {std::asin(a.value), a.derivative / std::sqrt(1 - a.value * a.value)}; }
+static inline auto acos(Dual a) -> Dual { return {std::acos(a.value), -a.derivative / std::sqrt(1 - a.value * a.value)}; }
+static inline auto atan(Dual a) -> Dual { return {std::atan(a.value), a.derivative / (1 + a.value * a.value)}; }
+static inline auto sqrt(Dual a) -> Dual
+{
+    f64 root = std::sqrt(a.value);
+    return {root, a.derivative / (2 * root)};
+}
+static inline auto log(Dual a) -> Dual { return {std::log(a.value), a.derivative / a.value}; }
+static inline auto floor(Dual a) -> Dual { return {std::floor(a.value), 0}; }
+static inline auto fmod(Dual a, Dual b) -> Dual
+{
+    f64 quotient = std::trunc(a.value / b.value);
+    return {std::fmod(a.value, b.value), a.derivative - quotient * b.derivative};
+}
+static inline auto pow(Dual a, Dual b) -> Dual
+{
+    f64 value = std::pow(a.value, b.value);
+
+    // Constant exponent use power rule so negative base still have derivative
+    if (b.derivative == 0)
+        return {value, b.value * std::pow(a.value, b.value - 1) * a.derivative};
+
+    return {value, value * (b.derivative * std::log(a.value) + b.value * a.derivative / a.value)};
+}
+
+template <typename T>
+static inline auto constant(f64 a) -> T { return static_cast<T>(a); }
+template <>
+inline auto constant<Dual>(f64 a) -> Dual { return {a, 0}; }
+
+static inline auto value_of(f64 a) -> f64 { return a; }
+static inline auto value_of(f32 a) -> f32 { return a; }
+static inline auto value_of(Dual a) -> f64 { return a.value; }
+
+// Comparison and logical operator produce 1 or 0, any non zero value is true
+template <typename T>
+static inline auto from_bool(bool a) -> T { return a ? constant<T>(1.0L) : constant<T>(0.0L); }
+template <typename T>
+static inline auto is_true(T a) -> bool { return value_of(a) != 0; }
+
+// Both side is taken by value so the load is unconditional and the select become a blend
+template <typename T>
+static inline auto masked_select(bool mask, T a, T b) -> T { return mask ? a : b; }
+
+// Exact Rational
+
+constexpr i128 I128_MIN = static_cast<i128>(static_cast<unsigned __int128>(1) << 127);
+
+static inline auto value_of(Rational a) -> f64 { return static_cast<f64>(a.numerator) / static_cast<f64>(a.denominator); }
+
+static inline auto gcd(i128 a, i128 b) -> i128
+{
+    a = a < 0 ? -a : a;
+    b = b < 0 ? -b : b;
+    while (b != 0)
+    {
+        i128 remainder = a % b;
+        a = b;
+        b = remainder;
+    }
+
+    return a;
+}
+
+static inline auto normalize(i128 __numerator, i128 __denominator) -> Rational
+{
+    // Negating the minimum doesn't fit, treat it as overflow
+    if (__denominator == 0 || __numerator == I128_MIN || __denominator == I128_MIN)
+        return {0, 0};
+
+    if (__denominator < 0)
+        __numerator = -__numerator, __denominator = -__denominator;
+
+    i128 divisor = gcd(__numerator, __denominator);
+    return {__numerator / divisor, __denominator / divisor};
+}
+
+static auto apply_exact(TokenType __op, Rational __lhs, Rational __rhs) -> Rational
+{
+    i128 a = __lhs.numerator, b = __lhs.denominator, c = __rhs.numerator, d = __rhs.denominator;
+    bool is_integer = b == 1 && d == 1;
+    i128 x, y, z;
+
+    switch (__op)
+    {
+    case TokenType::Subtract:
+        if (c == I128_MIN)
+            return {0, 0};
+
+        c = -c;
+        [[fallthrough]];
+    case TokenType::Plus:
+        if (is_integer)
+            return __builtin_add_overflow(a, c, &x) ? Rational{0, 0} : Rational{x, 1};
+
+        if (__builtin_mul_overflow(a, d, &x) || __builtin_mul_overflow(c, b, &y) || __builtin_add_overflow(x, y, &x) || __builtin_mul_overflow(b, d, &z))
+            return {0, 0};
+
+        return normalize(x, z);
+    case TokenType::Multiply:
+        if (__builtin_mul_overflow(a, c, &x) || __builtin_mul_overflow(b, d, &y))
+            return {0, 0};
+
+        return is_integer ? Rational{x, 1} : normalize(x, y);
+    case TokenType::Divide:
+        if (c == 0 || __builtin_mul_overflow(a, d, &x) || __builtin_mul_overflow(b, c, &y))
+            return {0, 0};
+
+        return normalize(x, y);
+    case TokenType::Modulo:
+        // Truncated remainder like fmod, a/b % c/d is (ad % cb) / bd
+        if (c == 0 || __builtin_mul_overflow(a, d, &x) || __builtin_mul_overflow(c, b, &y) || __builtin_mul_overflow(b, d, &z))
+            return {0, 0};
+
+        return normalize(y == -1 ? 0 : x % y, z);
+    case TokenType::PowerOperator:
+    {
+        if (d != 1 || c == I128_MIN || (c < 0 && a == 0))
+            return {0, 0};
+
+        // Exponentiation by squaring, power of reduced fraction stay reduced
+        Rational base = c < 0 ? normalize(b, a) : __lhs;
+        Rational result = {1, 1};
+        for (i128 exponent = c < 0 ? -c : c; exponent != 0; exponent >>= 1)
+        {
+            if ((exponent & 1) && (__builtin_mul_overflow(result.numerator, base.numerator, &result.numerator) ||
+                                   __builtin_mul_overflow(result.denominator, base.denominator, &result.denominator)))
+                return {0, 0};
+
+            if ((exponent >> 1) != 0 && (__builtin_mul_overflow(base.numerator, base.numerator, &base.numerator) ||
+                                         __builtin_mul_overflow(base.denominator, base.denominator, &base.denominator)))
+                return {0, 0};
+        }
+
+        return result;
+    }
+    case TokenType::And:
+        return {a != 0 && c != 0, 1};
+    case TokenType::Or:
+        return {a != 0 || c != 0, 1};
+    default:
+        break;
+    }
+
+    // Comparison, denominator is positive so cross multiplying keep the order
+    if (__builtin_mul_overflow(a, d, &x) || __builtin_mul_overflow(c, b, &y))
+        return {0, 0};
+
+    switch (__op)
+    {
+    case TokenType::Less: return {x < y, 1};
+    case TokenType::LessEqual: return {x <= y, 1};
+    case TokenType::Greater: return {x > y, 1};
+    case TokenType::GreaterEqual: return {x >= y, 1};
+    case TokenType::Equal: return {x == y, 1};
+    case TokenType::NotEqual: return {x != y, 1};
+    default: return {0, 0};
+    }
+}
+
+static inline auto is_exact_operator(TokenType __type) -> bool
+{
+    return (__type >= TokenType::Plus && __type <= TokenType::PowerOperator) || (__type >= TokenType::Less && __type <= TokenType::Or);
+}
+
+static auto parse_rational(const std::string &__src) -> Rational
+{
+    // Decimal literal is exact as long as it fit, e.g 1.25 is 125 / 100
+    bool is_negative = !__src.empty() && __src[0] == '-';
+    bool is_fraction = false;
+    bool has_digit = false;
+    i128 numerator = 0, denominator = 1;
+
+    for (std::size_t i = is_negative ? 1 : 0; i < __src.length(); i++)
+    {
+        if (__src[i] == '.' && !is_fraction)
+        {
+            is_fraction = true;
+            continue;
+        }
+
+        if (!std::isdigit(__src[i]) || __builtin_mul_overflow(numerator, 10, &numerator) || __builtin_add_overflow(numerator, __src[i] - '0', &numerator))
+            return {0, 0};
+
+        if (is_fraction && __builtin_mul_overflow(denominator, 10, &denominator))
+            return {0, 0};
+
+        has_digit = true;
+    }
+
+    return has_digit ? normalize(is_negative ? -numerator : numerator, denominator) : Rational{0, 0};
+}
+
+// Profiler
+
+static inline auto read_cycles() -> u64
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+auto ProfileCounters::should_sample() -> bool
+{
+    u32 every = this->sample_every.load(std::memory_order_relaxed);
+    return every != 0 && this->tick.fetch_add(1, std::memory_order_relaxed) % every == 0;
+}
+
+/**
+ * @brief Sampling decision of the top level evaluation running on this thread, nested program follow it
+ * so the sample rate doesn't depend on how many nested program one evaluation run
+ *
+ */
+static thread_local bool is_sampled = false;
+
+/**
+ * @brief Roll the sampling decision once for a top level evaluation and keep it until the end of the scope
+ *
+ */
+class SampleScope
+{
+private:
+    bool m_previous;
+
+public:
+    SampleScope(bool is_sampled_scope) : m_previous(is_sampled) { is_sampled = is_sampled_scope; }
+    SampleScope(const Rori::Math::Program &program) : SampleScope(program.profile && program.profile->should_sample()) {}
+    ~SampleScope() { is_sampled = this->m_previous; }
+
+    SampleScope(const SampleScope &) = delete;
+    SampleScope &operator=(const SampleScope &) = delete;
+};
+
+/**
+ * @brief Charge the cycle between two opcode to the former, do nothing when the evaluation is not sampled
+ *
+ */
+class Sampler
+{
+private:
+    const Rori::Math::Program *m_program = nullptr;
+    std::size_t m_opcode = 0;
+    u64 m_start = 0;
+    u64 m_lanes;
+
+    auto record(u64 now) -> void
+    {
+        this->m_program->profile->count[this->m_opcode].fetch_add(this->m_lanes, std::memory_order_relaxed);
+        this->m_program->profile->cycles[this->m_opcode].fetch_add(now - this->m_start, std::memory_order_relaxed);
+    }
+
+public:
+    Sampler(const Rori::Math::Program &program, u64 lanes) : m_lanes(lanes)
+    {
+        if (program.profile && is_sampled)
+            this->m_program = &program;
+    }
+
+    ~Sampler()
+    {
+        if (this->m_program && this->m_start != 0)
+            this->record(read_cycles());
+    }
+
+    auto next(const Token &token) -> void
+    {
+        if (!this->m_program)
+            return;
+
+        u64 now = read_cycles();
+        if (this->m_start != 0)
+            this->record(now);
+
+        this->m_opcode = opcode_of(*this->m_program, token);
+        this->m_start = read_cycles();
+    }
+};
+
+static auto opcode_of(const Rori::Math::Program &__program, const Token &__token) -> std::size_t
+{
+    if (__token.get_token() == TokenType::Function)
+        return OPCODE_FUNCTION_OFFSET + __token.get_function_type();
+
+    if (__token.get_token() == TokenType::Reduction)
+        return OPCODE_REDUCTION_OFFSET + __program.reductions[__token.get_slot()].type;
+
+    return __token.get_token();
+}
+
+static auto is_inclusive_opcode(std::size_t __opcode) -> bool
+{
+    return __opcode >= OPCODE_REDUCTION_OFFSET || __opcode == TokenType::Conditional || __opcode == TokenType::ArrayLiteral;
+}
+
+static auto opcode_name(std::size_t __opcode) -> std::string
+{
+    static const char *TOKEN_NAMES[] = {"const", "add", "sub", "mul", "div", "mod", "pow", "(", ")", "call", "load", "reduce", "array",
+                                        "lt", "le", "gt", "ge", "eq", "ne", "and", "or", "if", "jump_false", "jump_true"};
+    static const char *FUNCTION_NAMES[] = {"sin", "cos", "tan", "acos", "asin", "atan", "sqrt", "log", "floor", "array_sum", "mean", "min", "max"};
+    static const char *REDUCTION_NAMES[] = {"sum", "prod", "integrate"};
+
+    if (__opcode >= OPCODE_REDUCTION_OFFSET)
+        return REDUCTION_NAMES[__opcode - OPCODE_REDUCTION_OFFSET];
+    if (__opcode >= OPCODE_FUNCTION_OFFSET)
+        return FUNCTION_NAMES[__opcode - OPCODE_FUNCTION_OFFSET];
+
+    return TOKEN_NAMES[__opcode];
+}
+
+static auto attach_profile(Rori::Math::Program &__program, const std::shared_ptr<ProfileCounters> &__profile) -> void
+{
+    __program.profile = __profile;
+
+    for (auto &reduction : __program.reductions)
+    {
+        attach_profile(reduction.lower, __profile);
+        attach_profile(reduction.upper, __profile);
+        attach_profile(reduction.body, __profile);
+    }
+
+    for (auto &array : __program.arrays)
+        for (auto &element : array)
+            attach_profile(element, __profile);
+
+    for (auto &conditional : __program.conditionals)
+    {
+        attach_profile(conditional.condition, __profile);
+        attach_profile(conditional.then, __profile);
+        attach_profile(conditional.otherwise, __profile);
+    }
+}
+
+static auto explain_program(const Rori::Math::Program &__program, std::ostream &__os, std::size_t __indent) -> void
+{
+    std::string indent(__indent, ' ');
+
+    for (std::size_t i = 0; i < __program.code.size(); i++)
+    {
+        const Token &token = __program.code[i];
+        __os << indent << i << "\t" << opcode_name(opcode_of(__program, token));
+
+        if (token.get_token() == TokenType::Number)
+            __os << "\t" << token.get_value();
+        else if (token.get_token() == TokenType::Variable)
+            __os << "\t" << __program.variables[token.get_slot()];
+        else if (token.get_token() == TokenType::JumpIfFalse || token.get_token() == TokenType::JumpIfTrue)
+            __os << "\t" << token.get_slot() + 1;
+        __os << "\n";
+
+        if (token.get_token() == TokenType::Reduction)
+        {
+            auto &reduction = __program.reductions[token.get_slot()];
+            __os << indent << "  lower:\n";
+            explain_program(reduction.lower, __os, __indent + 4);
+            __os << indent << "  upper:\n";
+            explain_program(reduction.upper, __os, __indent + 4);
+            __os << indent << "  body (" << reduction.body.variables.back() << "):\n";
+            explain_program(reduction.body, __os, __indent + 4);
+        }
+
+        if (token.get_token() == TokenType::ArrayLiteral)
+        {
+            auto &array = __program.arrays[token.get_slot()];
+            for (std::size_t e = 0; e < array.size(); e++)
+            {
+                __os << indent << "  element " << e << ":\n";
+                explain_program(array[e], __os, __indent + 4);
+            }
+        }
+
+        if (token.get_token() == TokenType::Conditional)
+        {
+            auto &conditional = __program.conditionals[token.get_slot()];
+            __os << indent << "  condition:\n";
+            explain_program(conditional.condition, __os, __indent + 4);
+            __os << indent << "  then:\n";
+            explain_program(conditional.then, __os, __indent + 4);
+            __os << indent << "  else:\n";
+            explain_program(conditional.otherwise, __os, __indent + 4);
+        }
+    }
+}
+
+// Expression Class
+
+Rori::Math::Expression::Expression(std::shared_ptr<const Program> program)
+    : m_program(std::move(program)) {}
+
+auto Rori::Math::Expression::evaluate(const std::vector<f64> &__values) const -> Result<f64, Rori::Math::ErrorKind>
+{
+    if (!this->m_program)
+        return {-1, Rori::Math::ErrorKind::SyntaxError};
+
+    if (__values.size() != this->m_program->variables.size())
+        return {-1, Rori::Math::ErrorKind::UnboundVariable};
+
+    if (this->m_program->length != 1)
+        return {-1, Rori::Math::ErrorKind::ShapeMismatch};
+
+    return {evaluate_program(*this->m_program, __values.data()), Rori::Math::ErrorKind::None};
+}
+
+auto Rori::Math::Expression::evaluate_array(const std::vector<std::vector<f32>> &__values) const -> Result<std::vector<f32>, Rori::Math::ErrorKind>
+{
+    if (!this->m_program)
+        return {std::vector<f32>(), Rori::Math::ErrorKind::SyntaxError};
+
+    if (__values.size() != this->m_program->variables.size())
+        return {std::vector<f32>(), Rori::Math::ErrorKind::UnboundVariable};
+
+    for (auto &value : __values)
+        if (value.empty())
+            return {std::vector<f32>(), Rori::Math::ErrorKind::ShapeMismatch};
+
+    SampleScope sample(*this->m_program);
+    return execute_array(*this->m_program, __values.data());
+}
+
+auto Rori::Math::Expression::evaluate_batch(const f32 *const *__columns, std::size_t __count, f32 *__out) const -> Rori::Math::ErrorKind
+{
+    if (!this->m_program)
+        return Rori::Math::ErrorKind::SyntaxError;
+
+    if (this->m_program->length != 1)
+        return Rori::Math::ErrorKind::ShapeMismatch;
+
+    // Only spread across thread when every worker get enough block to pay for the thread
+    constexpr std::size_t PARALLEL_THRESHOLD = 256;
+    const Program &program = *this->m_program;
+    std::size_t block_count = (__count + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    std::size_t workers_size = block_count >= PARALLEL_THRESHOLD ? worker_count(block_count / PARALLEL_THRESHOLD) : 1;
+    std::size_t chunk = (block_count + workers_size - 1) / workers_size;
+
+    run_workers(workers_size, [&](std::size_t worker)
+                {
+                    std::vector<f32> stack(program.stack_size * BLOCK_SIZE);
+                    std::vector<const f32 *> pointers(program.variables.size());
+                    std::size_t end = std::min(block_count, (worker + 1) * chunk);
+
+                    for (std::size_t block = worker * chunk; block < end; block++)
+                    {
+                        std::size_t offset = block * BLOCK_SIZE;
+                        std::size_t size = std::min(BLOCK_SIZE, __count - offset);
+                        for (std::size_t v = 0; v < pointers.size(); v++)
+                            pointers[v] = __columns[v] + offset;
+
+                        SampleScope sample(program);
+                        execute_block(program, pointers.data(), size, stack.data());
+                        std::copy(stack.begin(), stack.begin() + size, __out + offset);
+                    } });
+
+    return Rori::Math::ErrorKind::None;
+}
+
+auto Rori::Math::Expression::explain(std::ostream &__os) const -> void
+{
+    if (!this->m_program)
+        return;
+
+    __os << "stack size\t: " << this->m_program->stack_size << "\n";
+    explain_program(*this->m_program, __os, 0);
+}
+
+auto Rori::Math::Expression::set_sampling(u32 __every) const -> void
+{
+    if (this->m_program && this->m_program->profile)
+        this->m_program->profile->sample_every.store(__every, std::memory_order_relaxed);
+}
+
+auto Rori::Math::Expression::get_profile() const -> std::vector<OpcodeProfile>
+{
+    std::vector<OpcodeProfile> profile;
+    if (!this->m_program || !this->m_program->profile)
+        return profile;
+
+    for (std::size_t opcode = 0; opcode < OPCODE_COUNT; opcode++)
+    {
+        u64 count = this->m_program->profile->count[opcode].load(std::memory_order_relaxed);
+        if (count != 0)
+            profile.push_back({opcode_name(opcode), count, this->m_program->profile->cycles[opcode].load(std::memory_order_relaxed), is_inclusive_opcode(opcode)});
+    }
+
+    std::sort(profile.begin(), profile.end(), [](const OpcodeProfile &a, const OpcodeProfile &b)
+              { return a.cycles > b.cycles; });
+
+    return profile;
+}
+
+auto Rori::Math::Expression::get_program() const -> const std::shared_ptr<const Program> &
+{
+    return this->m_program;
+}
+
+// Math Solver Class
+
+auto Rori::Math::MathSolver::evaluate(const std::string &__src) -> Result<f64, Rori::Math::ErrorKind>
+{
+    auto [program, err] = compile_program(__src, {});
+
+    if (err != Rori::Math::ErrorKind::None)
+        return {-1, err};
+
+    if (program.length != 1)
+        return {-1, Rori::Math::ErrorKind::ShapeMismatch};
+
+    return {evaluate_program(program, nullptr), Rori::Math::ErrorKind::None};
+}
+
+auto Rori::Math::MathSolver::evaluate_array(const std::string &__src) -> Result<std::vector<f32>, Rori::Math::ErrorKind>
+{
+    auto [program, err] = compile_program(__src, {});
+
+    if (err != Rori::Math::ErrorKind::None)
+        return {std::vector<f32>(), err};
+
+    return execute_array<f32>(program, nullptr);
+}
+
+auto Rori::Math::MathSolver::compile(const std::string &__src, const std::vector<std::string> &__variables) -> Result<Expression, Rori::Math::ErrorKind>
+{
+    // Variable is resolved before numeric literal, so a name like "2" would silently replace the literal
+    for (auto &variable : __variables)
+        if (!is_identifier(variable))
+            return {Expression(), Rori::Math::ErrorKind::SyntaxError};
+
+    auto [program, err] = compile_program(__src, __variables);
+
+    if (err != Rori::Math::ErrorKind::None)
+        return {Expression(), err};
+
+    attach_profile(program, std::make_shared<ProfileCounters>());
+
+    return {Expression(std::make_shared<const Program>(std::move(program))), Rori::Math::ErrorKind::None};
+}
+
+auto Rori::Math::MathSolver::solve(const std::string &__src, const std::string &__variable, Interval __interval) -> Result<std::vector<Root>, Rori::Math::ErrorKind>
+{
+    if (!(__interval.lower < __interval.upper))
+        return {std::vector<Root>(), Rori::Math::ErrorKind::InvalidInterval};
+
+    if (!is_identifier(__variable))
+        return {std::vector<Root>(), Rori::Math::ErrorKind::SyntaxError};
+
+    // Split "f(x) = c" into "(f(x)) - (c)", comparison like "<=" or "==" is not an equation
+    std::string equation = __src;
+    std::size_t equal_sign = std::string::npos;
+    for (std::size_t i = 0; i < __src.length(); i++)
+    {
+        if (__src[i] != '=')
+            continue;
+
+        bool is_part_of_operator = (i > 0 && std::string("<>=!").find(__src[i - 1]) != std::string::npos) ||
+                                   (i + 1 < __src.length() && __src[i + 1] == '=');
+        if (is_part_of_operator)
+            continue;
+
+        if (equal_sign != std::string::npos)
+            return {std::vector<Root>(), Rori::Math::ErrorKind::SyntaxError};
+
+        equal_sign = i;
+    }
+
+    if (equal_sign != std::string::npos)
+        equation = std::string("(").append(__src, 0, equal_sign).append(")-(").append(__src, equal_sign + 1).append(")");
+
+    auto [program, err] = compile_program(equation, {__variable});
+
+    if (err != Rori::Math::ErrorKind::None)
+        return {std::vector<Root>(), err};
+
+    if (program.length != 1)
+        return {std::vector<Root>(), Rori::Math::ErrorKind::ShapeMismatch};
+
+    // Every worker own contiguous segments, segment count is fixed so result doesn't depend on the machine
+    constexpr std::size_t SEGMENT_COUNT = 1024;
+    std::size_t workers_size = worker_count(SEGMENT_COUNT);
+    std::size_t chunk = (SEGMENT_COUNT + workers_size - 1) / workers_size;
+
+    std::vector<std::vector<Root>> partial(workers_size);
+    run_workers(workers_size, [&](std::size_t worker)
+                {
+                    std::size_t segment_start = std::min(worker * chunk, SEGMENT_COUNT);
+                    std::size_t segment_end = std::min(segment_start + chunk, SEGMENT_COUNT);
+                    partial[worker] = find_roots(program, __interval.lower, __interval.upper, segment_start, segment_end, SEGMENT_COUNT); });
+
+    std::vector<Root> roots;
+    for (auto &found : partial)
+        roots.insert(roots.end(), found.begin(), found.end());
+
+    std::sort(roots.begin(), roots.end(), [](const Root &a, const Root &b)
+              { return a.value < b.value; });
+
+    // Neighbouring segment may converge into the same root, keep the one that converge faster
+    std::vector<Root> unique_roots;
+    for (auto &root : roots)
+    {
+        bool is_same_root = !unique_roots.empty() && std::fabs(unique_roots.back().value - root.value) <= 1e-8 * (1 + std::fabs(root.value));
+
+        if (!is_same_root)
+            unique_roots.push_back(root);
+        else if (root.iterations < unique_roots.back().iterations)
+            unique_roots.back() = root;
+    }
+
+    return {unique_roots, Rori::Math::ErrorKind::None};
+}
+
+template <typename T>
+static auto execute(const Rori::Math::Program &__program, const T *__values) -> T
+{
+    // Array literal need the array evaluator, every variable is bound to single element array
+    if (!__program.arrays.empty())
+    {
+        std::vector<std::vector<T>> values(__program.variables.size());
+        for (std::size_t v = 0; v < values.size(); v++)
+            values[v] = {__values[v]};
+
+        auto [result, err] = execute_array(__program, values.data());
+        return err == Rori::Math::ErrorKind::None && result.size() == 1 ? result[0] : constant<T>(NAN);
+    }
+
+    constexpr std::size_t INLINE_STACK_SIZE = 32;
+    T inline_stack[INLINE_STACK_SIZE];
+    std::vector<T> heap_stack;
+    T *stack = inline_stack;
+
+    if (__program.stack_size > INLINE_STACK_SIZE)
+    {
+        heap_stack.resize(__program.stack_size);
+        stack = heap_stack.data();
+    }
+
+    using std::sin, std::cos, std::tan, std::asin, std::acos, std::atan, std::sqrt, std::log, std::floor, std::fmod, std::pow;
+
+    Sampler sampler(__program, 1);
+    std::size_t top = 0;
+    for (std::size_t i = 0; i < __program.code.size(); i++)
+    {
+        const Token &token = __program.code[i];
+        sampler.next(token);
+        switch (token.get_token())
+        {
+        case TokenType::Number:
+            stack[top++] = constant<T>(token.get_value());
+            continue;
+        case TokenType::Variable:
+            stack[top++] = __values[token.get_slot()];
+            continue;
+        case TokenType::Reduction:
+            stack[top++] = reduce(__program.reductions[token.get_slot()], __values);
+            continue;
+        case TokenType::Conditional:
+        {
+            // Only the taken branch is evaluated
+            auto &conditional = __program.conditionals[token.get_slot()];
+            stack[top++] = is_true(execute(conditional.condition, __values)) ? execute(conditional.then, __values) : execute(conditional.otherwise, __values);
+            continue;
+        }
+        case TokenType::JumpIfFalse:
+        case TokenType::JumpIfTrue:
+        {
+            // Left side already decide "and" / "or", skip the right side and its operator
+            T &op = stack[top - 1];
+            bool is_jump_when = token.get_token() == TokenType::JumpIfTrue;
+            if (is_true(op) == is_jump_when)
+            {
+                op = from_bool<T>(is_jump_when);
+                i = token.get_slot();
+            }
+            continue;
+        }
+        case TokenType::Function:
+        {
+            T &op = stack[top - 1];
+            switch (token.get_function_type())
+            {
+            case FunctionType::Sin: op = sin(op); break;
+            case FunctionType::Cos: op = cos(op); break;
+            case FunctionType::Tan: op = tan(op); break;
+            case FunctionType::Acos: op = acos(op); break;
+            case FunctionType::Asin: op = asin(op); break;
+            case FunctionType::Atan: op = atan(op); break;
+            case FunctionType::Sqrt: op = sqrt(op); break;
+            case FunctionType::Log: op = log(op); break;
+            case FunctionType::Floor: op = floor(op); break;
+            default: break;
+            }
+            continue;
+        }
+        default:
+            break;
+        }
+
+        T rhs = stack[--top];
+        T &lhs = stack[top - 1];
+        switch (token.get_token())
+        {
+        case TokenType::Plus: lhs = lhs + rhs; break;
+        case TokenType::Subtract: lhs = lhs - rhs; break;
+        case TokenType::Multiply: lhs = lhs * rhs; break;
+        case TokenType::Divide: lhs = lhs / rhs; break;
+        case TokenType::PowerOperator: lhs = pow(lhs, rhs); break;
+        case TokenType::Modulo: lhs = fmod(lhs, rhs); break;
+        case TokenType::Less: lhs = from_bool<T>(value_of(lhs) < value_of(rhs)); break;
+        case TokenType::LessEqual: lhs = from_bool<T>(value_of(lhs) <= value_of(rhs)); break;
+        case TokenType::Greater: lhs = from_bool<T>(value_of(lhs) > value_of(rhs)); break;
+        case TokenType::GreaterEqual: lhs = from_bool<T>(value_of(lhs) >= value_of(rhs)); break;
+        case TokenType::Equal: lhs = from_bool<T>(value_of(lhs) == value_of(rhs)); break;
+        case TokenType::NotEqual: lhs = from_bool<T>(value_of(lhs) != value_of(rhs)); break;
+        case TokenType::And: lhs = from_bool<T>(is_true(lhs) && is_true(rhs)); break;
+        case TokenType::Or: lhs = from_bool<T>(is_true(lhs) || is_true(rhs)); break;
+        default: break;
+        }
+    }
+
+    return stack[0];
+}
+
+static auto execute_exact(const Rori::Math::Program &__program, const f64 *__values) -> Rational
+{
+    constexpr std::size_t INLINE_STACK_SIZE = 32;
+    Rational inline_stack[INLINE_STACK_SIZE];
+    std::vector<Rational> heap_stack;
+    Rational *stack = inline_stack;
+
+    if (__program.stack_size > INLINE_STACK_SIZE)
+    {
+        heap_stack.resize(__program.stack_size);
+        stack = heap_stack.data();
+    }
+
+    Sampler sampler(__program, 1);
+    std::size_t top = 0;
+    for (std::size_t i = 0; i < __program.code.size(); i++)
+    {
+        const Token &token = __program.code[i];
+        sampler.next(token);
+        switch (token.get_token())
+        {
+        case TokenType::Number:
+            stack[top++] = token.get_exact();
+            continue;
+        case TokenType::Variable:
+        {
+            f64 value = __values[token.get_slot()];
+            if (!(std::fabs(value) < 0x1p100L) || std::floor(value) != value)
+                return {0, 0};
+
+            stack[top++] = {static_cast<i128>(value), 1};
+            continue;
+        }
+        case TokenType::Conditional:
+        {
+            auto &conditional = __program.conditionals[token.get_slot()];
+            Rational condition = execute_exact(conditional.condition, __values);
+            if (condition.denominator == 0)
+                return condition;
+
+            Rational result = execute_exact(condition.numerator != 0 ? conditional.then : conditional.otherwise, __values);
+            if (result.denominator == 0)
+                return result;
+
+            stack[top++] = result;
+            continue;
+        }
+        case TokenType::JumpIfFalse:
+        case TokenType::JumpIfTrue:
+        {
+            Rational &op = stack[top - 1];
+            bool is_jump_when = token.get_token() == TokenType::JumpIfTrue;
+            if ((op.numerator != 0) == is_jump_when)
+            {
+                op = {is_jump_when, 1};
+                i = token.get_slot();
+            }
+            continue;
+        }
+        default:
+            break;
+        }
+
+        Rational rhs = stack[--top];
+        Rational &lhs = stack[top - 1];
+        lhs = apply_exact(token.get_token(), lhs, rhs);
+        if (lhs.denominator == 0)
+            return lhs;
+    }
+
+    return stack[0];
+}
+
+static auto evaluate_program(const Rori::Math::Program &__program, const f64 *__values) -> f64
+{
+    // Exact attempt and its floating point fallback are one evaluation, so they share one sampling decision
+    SampleScope sample(__program);
+
+    // Integer and rational only program stay exact until it overflow or get non integer input
+    if (__program.is_exact)
+    {
+        Rational exact = execute_exact(__program, __values);
+        if (exact.denominator != 0)
+            return value_of(exact);
+    }
+
+    return execute(__program, __values);
+}
+
+static auto find_roots(const Rori::Math::Program &__program, f64 __lower, f64 __upper, std::size_t __segment_start, std::size_t __segment_end, std::size_t __segment_count) -> std::vector<Rori::Math::Root>
+{
+    constexpr u32 MAX_ITERATION = 100;
+    constexpr f64 TOLERANCE = 1e-12;
+
+    std::vector<Rori::Math::Root> roots;
+    f64 width = (__upper - __lower) / __segment_count;
+
+    auto f = [&](f64 x)
+    {
+        return execute<f64>(__program, &x);
+    };
+    auto df = [&](f64 x)
+    {
+        Dual dx = {x, 1};
+        return execute<Dual>(__program, &dx);
+    };
+
+    f64 left = __lower + width * __segment_start;
+    f64 f_left = f(left);
+
+    for (std::size_t segment = __segment_start; segment < __segment_end; segment++)
+    {
+        f64 right = segment + 1 == __segment_count ? __upper : __lower + width * (segment + 1);
+        f64 f_right = f(right);
+
+        if (f_left == 0)
+            roots.push_back({left, 0});
+        if (segment + 1 == __segment_count && f_right == 0)
+            roots.push_back({right, 0});
+
+        bool is_bracketed = (f_left < 0 && f_right > 0) || (f_left > 0 && f_right < 0);
+        f64 low = left, high = right, f_low = f_left;
+        f64 x = (left + right) / 2;
+
+        // Newton step, fallback to bisection when the step leave the bracket
+        for (u32 iteration = 1; iteration <= MAX_ITERATION; iteration++)
+        {
+            Dual y = df(x);
+            if (std::isnan(y.value))
+                break;
+
+            if (y.value == 0)
+            {
+                roots.push_back({x, iteration});
+                break;
+            }
+
+            if (is_bracketed)
+            {
+                if ((y.value < 0) == (f_low < 0))
+                    low = x, f_low = y.value;
+                else
+                    high = x;
+            }
+
+            f64 next = x - y.value / y.derivative;
+            bool is_converged = std::isfinite(next) && std::fabs(next - x) <= TOLERANCE * (1 + std::fabs(x));
+
+            if (is_bracketed && !is_converged && !(next > low && next < high))
+            {
+                next = (low + high) / 2;
+                is_converged = high - low <= TOLERANCE * (1 + std::fabs(x));
+            }
+
+            if (!std::isfinite(next) || (!is_bracketed && (next < left || next > right)))
+                break;
+
+            x = is_bracketed ? std::clamp(next, low, high) : next;
+
+            if (is_converged)
+            {
+                // Sign change across a pole or a jump is not a root, only accept point that actually touch zero
+                f64 magnitude = std::max(std::isfinite(f_left) ? std::fabs(f_left) : 0, std::isfinite(f_right) ? std::fabs(f_right) : 0);
+                f64 scale = is_bracketed ? 1e-8 * (1 + magnitude) : 1e-10;
+                if (std::fabs(f(x)) <= scale)
+                    roots.push_back({x, iteration});
+                break;
+            }
+        }
+
+        left = right;
+        f_left = f_right;
+    }
+
+    return roots;
+}
+
+/**
+ * @brief Pointer to every variable lane inside buffer laid out as [variable][BLOCK_SIZE]
+ *
+ */
+template <typename T>
+static inline auto lane_pointers(const std::vector<T> &__lanes) -> std::vector<const T *>
+{
+    std::vector<const T *> pointers(__lanes.size() / BLOCK_SIZE);
+    for (std::size_t v = 0; v < pointers.size(); v++)
+        pointers[v] = __lanes.data() + v * BLOCK_SIZE;
+
+    return pointers;
+}
+
+/**
+ * @brief Pairwise accumulator, keep partial of 2^n element so rounding error only grow with log(n)
+ *
+ */
+template <typename T, bool IS_PRODUCT>
+struct Pairwise
+{
+    T levels[64];
+    u64 count = 0;
+
+    static inline auto combine(T a, T b) -> T { return IS_PRODUCT ? a * b : a + b; }
+
+    auto add(T value) -> void
+    {
+        u32 level = 0;
+        for (; (this->count >> level) & 1; level++)
+            value = combine(this->levels[level], value);
+
+        this->levels[level] = value;
+        this->count++;
+    }
+
+    auto total() const -> T
+    {
+        T result = constant<T>(IS_PRODUCT ? 1.0L : 0.0L);
+        for (u32 level = 0; level < 64; level++)
+            if ((this->count >> level) & 1)
+                result = combine(this->levels[level], result);
+
+        return result;
+    }
+};
+
+template <typename T>
+static auto execute_block(const Rori::Math::Program &__program, const T *const *__values, std::size_t __count, T *__stack) -> void
+{
+    using std::sin, std::cos, std::tan, std::asin, std::acos, std::atan, std::sqrt, std::log, std::floor, std::fmod, std::pow;
+
+    // Reduction inside a block run once per lane, it must not spawn its own thread
+    SerialScope serial;
+
+    if (!__program.arrays.empty())
+    {
+        std::vector<T> lane(__program.variables.size());
+        for (std::size_t k = 0; k < __count; k++)
+        {
+            for (std::size_t v = 0; v < lane.size(); v++)
+                lane[v] = __values[v][k];
+
+            __stack[k] = execute(__program, lane.data());
+        }
+        return;
+    }
+
+    Sampler sampler(__program, __count);
+    std::size_t top = 0;
+    for (auto &token : __program.code)
+    {
+        sampler.next(token);
+        switch (token.get_token())
+        {
+        case TokenType::Number:
+            std::fill(__stack + top * BLOCK_SIZE, __stack + top * BLOCK_SIZE + __count, constant<T>(token.get_value()));
+            top++;
+            continue;
+        case TokenType::Variable:
+            std::copy(__values[token.get_slot()], __values[token.get_slot()] + __count, __stack + top * BLOCK_SIZE);
+            top++;
+            continue;
+        case TokenType::Reduction:
+        {
+            std::vector<T> lane(__program.variables.size());
+            for (std::size_t k = 0; k < __count; k++)
+            {
+                for (std::size_t v = 0; v < lane.size(); v++)
+                    lane[v] = __values[v][k];
+
+                __stack[top * BLOCK_SIZE + k] = reduce(__program.reductions[token.get_slot()], lane.data());
+            }
+            top++;
+            continue;
+        }
+        case TokenType::Conditional:
+        {
+            // Every lane evaluate both branch and pick with a mask, so data dependent branch doesn't stall the loop.
+            // compile_program reserve the stack above top for the three program
+            auto &conditional = __program.conditionals[token.get_slot()];
+            T *__restrict condition = __stack + top * BLOCK_SIZE;
+            T *__restrict then = condition + BLOCK_SIZE;
+            T *__restrict otherwise = then + BLOCK_SIZE;
+
+            execute_block(conditional.condition, __values, __count, condition);
+            execute_block(conditional.then, __values, __count, then);
+            execute_block(conditional.otherwise, __values, __count, otherwise);
+            BLOCK_APPLY_BINARY(condition, then, __count, masked_select(is_true(condition[k]), then[k], otherwise[k]));
+            top++;
+            continue;
+        }
+        case TokenType::JumpIfFalse:
+        case TokenType::JumpIfTrue:
+            continue;
+        case TokenType::Function:
+        {
+            T *op = __stack + (top - 1) * BLOCK_SIZE;
+            switch (token.get_function_type())
+            {
+            case FunctionType::Sin: BLOCK_APPLY_UNARY(op, __count, sin); break;
+            case FunctionType::Cos: BLOCK_APPLY_UNARY(op, __count, cos); break;
+            case FunctionType::Tan: BLOCK_APPLY_UNARY(op, __count, tan); break;
+            case FunctionType::Acos: BLOCK_APPLY_UNARY(op, __count, acos); break;
+            case FunctionType::Asin: BLOCK_APPLY_UNARY(op, __count, asin); break;
+            case FunctionType::Atan: BLOCK_APPLY_UNARY(op, __count, atan); break;
+            case FunctionType::Sqrt: BLOCK_APPLY_UNARY(op, __count, sqrt); break;
+            case FunctionType::Log: BLOCK_APPLY_UNARY(op, __count, log); break;
+            case FunctionType::Floor: BLOCK_APPLY_UNARY(op, __count, floor); break;
+            default: break;
+            }
+            continue;
+        }
+        default:
+            break;
+        }
+
+        // Operand never overlap, restrict let the compiler vectorize without runtime alias check
+        top--;
+        T *__restrict lhs = __stack + (top - 1) * BLOCK_SIZE;
+        const T *__restrict rhs = __stack + top * BLOCK_SIZE;
+        switch (token.get_token())
+        {
+        case TokenType::Plus: BLOCK_APPLY_BINARY(lhs, rhs, __count, lhs[k] + rhs[k]); break;
+        case TokenType::Subtract: BLOCK_APPLY_BINARY(lhs, rhs, __count, lhs[k] - rhs[k]); break;
+        case TokenType::Multiply: BLOCK_APPLY_BINARY(lhs, rhs, __count, lhs[k] * rhs[k]); break;
+        case TokenType::Divide: BLOCK_APPLY_BINARY(lhs, rhs, __count, lhs[k] / rhs[k]); break;
+        case TokenType::PowerOperator: BLOCK_APPLY_BINARY(lhs, rhs, __count, pow(lhs[k], rhs[k])); break;
+        case TokenType::Modulo: BLOCK_APPLY_BINARY(lhs, rhs, __count, fmod(lhs[k], rhs[k])); break;
+        case TokenType::Less: BLOCK_APPLY_BINARY(lhs, rhs, __count, from_bool<T>(value_of(lhs[k]) < value_of(rhs[k]))); break;
+        case TokenType::LessEqual: BLOCK_APPLY_BINARY(lhs, rhs, __count, from_bool<T>(value_of(lhs[k]) <= value_of(rhs[k]))); break;
+        case TokenType::Greater: BLOCK_APPLY_BINARY(lhs, rhs, __count, from_bool<T>(value_of(lhs[k]) > value_of(rhs[k]))); break;
+        case TokenType::GreaterEqual: BLOCK_APPLY_BINARY(lhs, rhs, __count, from_bool<T>(value_of(lhs[k]) >= value_of(rhs[k]))); break;
+        case TokenType::Equal: BLOCK_APPLY_BINARY(lhs, rhs, __count, from_bool<T>(value_of(lhs[k]) == value_of(rhs[k]))); break;
+        case TokenType::NotEqual: BLOCK_APPLY_BINARY(lhs, rhs, __count, from_bool<T>(value_of(lhs[k]) != value_of(rhs[k]))); break;
+        case TokenType::And: BLOCK_APPLY_BINARY(lhs, rhs, __count, from_bool<T>(is_true(lhs[k]) & is_true(rhs[k]))); break;
+        case TokenType::Or: BLOCK_APPLY_BINARY(lhs, rhs, __count, from_bool<T>(is_true(lhs[k]) | is_true(rhs[k]))); break;
+        default: break;
+        }
+    }
+}
+
+template <typename T>
+static auto execute_array(const Rori::Math::Program &__program, const std::vector<T> *__values) -> Result<std::vector<T>, Rori::Math::ErrorKind>
+{
+    using std::sin, std::cos, std::tan, std::asin, std::acos, std::atan, std::sqrt, std::log, std::floor, std::fmod, std::pow;
+
+    std::vector<std::vector<T>> stack;
+    stack.reserve(__program.stack_size);
+
+    // Length every array input broadcast into, used when reduction need per element evaluation
+    std::size_t length = 1;
+    for (std::size_t v = 0; v < __program.variables.size(); v++)
+    {
+        if (__values[v].size() != 1 && length != 1 && __values[v].size() != length)
+            return {std::vector<T>(), Rori::Math::ErrorKind::ShapeMismatch};
+
+        length = std::max(length, __values[v].size());
+    }
+
+    Sampler sampler(__program, 1);
+    for (auto &token : __program.code)
+    {
+        sampler.next(token);
+        switch (token.get_token())
+        {
+        case TokenType::Number:
+            stack.push_back({constant<T>(token.get_value())});
+            continue;
+        case TokenType::Variable:
+            stack.push_back(__values[token.get_slot()]);
+            continue;
+        case TokenType::ArrayLiteral:
+        {
+            std::vector<T> array;
+            for (auto &element : __program.arrays[token.get_slot()])
+            {
+                auto [result, err] = execute_array(element, __values);
+
+                if (err != Rori::Math::ErrorKind::None)
+                    return {result, err};
+
+                array.insert(array.end(), result.begin(), result.end());
+            }
+
+            stack.push_back(std::move(array));
+            continue;
+        }
+        case TokenType::Reduction:
+        {
+            SerialScope serial(length > 1);
+            std::vector<T> result(length);
+            std::vector<T> lane(__program.variables.size());
+            for (std::size_t k = 0; k < length; k++)
+            {
+                for (std::size_t v = 0; v < lane.size(); v++)
+                    lane[v] = __values[v][__values[v].size() == 1 ? 0 : k];
+
+                result[k] = reduce(__program.reductions[token.get_slot()], lane.data());
+            }
+
+            stack.push_back(std::move(result));
+            continue;
+        }
+        case TokenType::Conditional:
+        {
+            auto &conditional = __program.conditionals[token.get_slot()];
+            auto [condition, err] = execute_array(conditional.condition, __values);
+            auto [then, err2] = execute_array(conditional.then, __values);
+            auto [otherwise, err3] = execute_array(conditional.otherwise, __values);
+
+            if (err != Rori::Math::ErrorKind::None || err2 != Rori::Math::ErrorKind::None || err3 != Rori::Math::ErrorKind::None)
+                return {std::vector<T>(), err != Rori::Math::ErrorKind::None ? err : (err2 != Rori::Math::ErrorKind::None ? err2 : err3)};
+
+            std::size_t size = std::max({condition.size(), then.size(), otherwise.size()});
+            for (auto *branch : {&condition, &then, &otherwise})
+                if (branch->size() != 1 && branch->size() != size)
+                    return {std::vector<T>(), Rori::Math::ErrorKind::ShapeMismatch};
+
+            std::vector<T> result(size);
+            for (std::size_t k = 0; k < size; k++)
+                result[k] = is_true(condition[condition.size() == 1 ? 0 : k]) ? then[then.size() == 1 ? 0 : k] : otherwise[otherwise.size() == 1 ? 0 : k];
+
+            stack.push_back(std::move(result));
+            continue;
+        }
+        case TokenType::JumpIfFalse:
+        case TokenType::JumpIfTrue:
+            continue;
+        case TokenType::Function:
+        {
+            std::vector<T> &op = stack.back();
+            std::size_t size = op.size();
+            switch (token.get_function_type())
+            {
+            case FunctionType::Sin: BLOCK_APPLY_UNARY(op, size, sin); break;
+            case FunctionType::Cos: BLOCK_APPLY_UNARY(op, size, cos); break;
+            case FunctionType::Tan: BLOCK_APPLY_UNARY(op, size, tan); break;
+            case FunctionType::Acos: BLOCK_APPLY_UNARY(op, size, acos); break;
+            case FunctionType::Asin: BLOCK_APPLY_UNARY(op, size, asin); break;
+            case FunctionType::Atan: BLOCK_APPLY_UNARY(op, size, atan); break;
+            case FunctionType::Sqrt: BLOCK_APPLY_UNARY(op, size, sqrt); break;
+            case FunctionType::Log: BLOCK_APPLY_UNARY(op, size, log); break;
+            case FunctionType::Floor: BLOCK_APPLY_UNARY(op, size, floor); break;
+            case FunctionType::ArraySum:
+            case FunctionType::ArrayMean:
+            {
+                Pairwise<T, false> sum;
+                for (auto &value : op)
+                    sum.add(value);
+
+                T total = sum.total();
+                op = {token.get_function_type() == FunctionType::ArraySum ? total : total / constant<T>(size)};
+                break;
+            }
+            case FunctionType::ArrayMin:
+                op = {*std::min_element(op.begin(), op.end(), [](const T &a, const T &b)
+                                        { return value_of(a) < value_of(b); })};
+                break;
+            case FunctionType::ArrayMax:
+                op = {*std::max_element(op.begin(), op.end(), [](const T &a, const T &b)
+                                        { return value_of(a) < value_of(b); })};
+                break;
+            }
+            continue;
+        }
+        default:
+            break;
+        }
+
+        std::vector<T> rhs = std::move(stack.back());
+        stack.pop_back();
+        std::vector<T> &lhs = stack.back();
+
+        if (lhs.size() != rhs.size() && lhs.size() != 1 && rhs.size() != 1)
+            return {std::vector<T>(), Rori::Math::ErrorKind::ShapeMismatch};
+
+        // Result is written to whichever side already has the final length, scalar side is read as broadcast
+        if (lhs.size() == 1 && rhs.size() != 1)
+        {
+            T scalar = lhs[0];
+            lhs = std::move(rhs);
+            switch (token.get_token())
+            {
+            case TokenType::Plus: BLOCK_APPLY_BINARY(lhs, lhs, lhs.size(), scalar + lhs[k]); break;
+            case TokenType::Subtract: BLOCK_APPLY_BINARY(lhs, lhs, lhs.size(), scalar - lhs[k]); break;
+            case TokenType::Multiply: BLOCK_APPLY_BINARY(lhs, lhs, lhs.size(), scalar * lhs[k]); break;
+            case TokenType::Divide: BLOCK_APPLY_BINARY(lhs, lhs, lhs.size(), scalar / lhs[k]); break;
+            case TokenType::PowerOperator: BLOCK_APPLY_BINARY(lhs, lhs, lhs.size(), pow(scalar, lhs[k])); break;
+            case TokenType::Modulo: BLOCK_APPLY_BINARY(lhs, lhs, lhs.size(), fmod(scalar, lhs[k])); break;
+            case TokenType::Less: BLOCK_APPLY_BINARY(lhs, lhs, lhs.size(), from_bool<T>(value_of(scalar) < value_of(lhs[k]))); break;
+            case TokenType::LessEqual: BLOCK_APPLY_BINARY(lhs, lhs, lhs.size(), from_bool<T>(value_of(scalar) <= value_of(lhs[k]))); break;
+            case TokenType::Greater: BLOCK_APPLY_BINARY(lhs, lhs, lhs.size(), from_bool<T>(value_of(scalar) > value_of(lhs[k]))); break;
+            case TokenType::GreaterEqual: BLOCK_APPLY_BINARY(lhs, lhs, lhs.size(), from_bool<T>(value_of(scalar) >= value_of(lhs[k]))); break;
+            case TokenType::Equal: BLOCK_APPLY_BINARY(lhs, lhs, lhs.size(), from_bool<T>(value_of(scalar) == value_of(lhs[k]))); break;
+            case TokenType::NotEqual: BLOCK_APPLY_BINARY(lhs, lhs, lhs.size(), from_bool<T>(value_of(scalar) != value_of(lhs[k]))); break;
+            case TokenType::And: BLOCK_APPLY_BINARY(lhs, lhs, lhs.size(), from_bool<T>(is_true(scalar) & is_true(lhs[k]))); break;
+            case TokenType::Or: BLOCK_APPLY_BINARY(lhs, lhs, lhs.size(), from_bool<T>(is_true(scalar) | is_true(lhs[k]))); break;
+            default: break;
+            }
+            continue;
+        }
+
+        if (rhs.size() == 1)
+        {
+            T scalar = rhs[0];
+            switch (token.get_token())
+            {
+            case TokenType::Plus: BLOCK_APPLY_BINARY(lhs, lhs, lhs.size(), lhs[k] + scalar); break;
+            case TokenType::Subtract: BLOCK_APPLY_BINARY(lhs, lhs, lhs.size(), lhs[k] - scalar); break;
+            case TokenType::Multiply: BLOCK_APPLY_BINARY(lhs, lhs, lhs.size(), lhs[k] * scalar); break;
+            case TokenType::Divide: BLOCK_APPLY_BINARY(lhs, lhs, lhs.size(), lhs[k] / scalar); break;
+            case TokenType::PowerOperator: BLOCK_APPLY_BINARY(lhs, lhs, lhs.size(), pow(lhs[k], scalar)); break;
+            case TokenType::Modulo: BLOCK_APPLY_BINARY(lhs, lhs, lhs.size(), fmod(lhs[k], scalar)); break;
+            case TokenType::Less: BLOCK_APPLY_BINARY(lhs, lhs, lhs.size(), from_bool<T>(value_of(lhs[k]) < value_of(scalar))); break;
+            case TokenType::LessEqual: BLOCK_APPLY_BINARY(lhs, lhs, lhs.size(), from_bool<T>(value_of(lhs[k]) <= value_of(scalar))); break;
+            case TokenType::Greater: BLOCK_APPLY_BINARY(lhs, lhs, lhs.size(), from_bool<T>(value_of(lhs[k]) > value_of(scalar))); break;
+            case TokenType::GreaterEqual: BLOCK_APPLY_BINARY(lhs, lhs, lhs.size(), from_bool<T>(value_of(lhs[k]) >= value_of(scalar))); break;
+            case TokenType::Equal: BLOCK_APPLY_BINARY(lhs, lhs, lhs.size(), from_bool<T>(value_of(lhs[k]) == value_of(scalar))); break;
+            case TokenType::NotEqual: BLOCK_APPLY_BINARY(lhs, lhs, lhs.size(), from_bool<T>(value_of(lhs[k]) != value_of(scalar))); break;
+            case TokenType::And: BLOCK_APPLY_BINARY(lhs, lhs, lhs.size(), from_bool<T>(is_true(lhs[k]) & is_true(scalar))); break;
+            case TokenType::Or: BLOCK_APPLY_BINARY(lhs, lhs, lhs.size(), from_bool<T>(is_true(lhs[k]) | is_true(scalar))); break;
+            default: break;
+            }
+            continue;
+        }
+
+        T *__restrict left = lhs.data();
+        const T *__restrict right = rhs.data();
+        std::size_t size = lhs.size();
+        switch (token.get_token())
+        {
+        case TokenType::Plus: BLOCK_APPLY_BINARY(left, right, size, left[k] + right[k]); break;
+        case TokenType::Subtract: BLOCK_APPLY_BINARY(left, right, size, left[k] - right[k]); break;
+        case TokenType::Multiply: BLOCK_APPLY_BINARY(left, right, size, left[k] * right[k]); break;
+        case TokenType::Divide: BLOCK_APPLY_BINARY(left, right, size, left[k] / right[k]); break;
+        case TokenType::PowerOperator: BLOCK_APPLY_BINARY(left, right, size, pow(left[k], right[k])); break;
+        case TokenType::Modulo: BLOCK_APPLY_BINARY(left, right, size, fmod(left[k], right[k])); break;
+        case TokenType::Less: BLOCK_APPLY_BINARY(left, right, size, from_bool<T>(value_of(left[k]) < value_of(right[k]))); break;
+        case TokenType::LessEqual: BLOCK_APPLY_BINARY(left, right, size, from_bool<T>(value_of(left[k]) <= value_of(right[k]))); break;
+        case TokenType::Greater: BLOCK_APPLY_BINARY(left, right, size, from_bool<T>(value_of(left[k]) > value_of(right[k]))); break;
+        case TokenType::GreaterEqual: BLOCK_APPLY_BINARY(left, right, size, from_bool<T>(value_of(left[k]) >= value_of(right[k]))); break;
+        case TokenType::Equal: BLOCK_APPLY_BINARY(left, right, size, from_bool<T>(value_of(left[k]) == value_of(right[k]))); break;
+        case TokenType::NotEqual: BLOCK_APPLY_BINARY(left, right, size, from_bool<T>(value_of(left[k]) != value_of(right[k]))); break;
+        case TokenType::And: BLOCK_APPLY_BINARY(left, right, size, from_bool<T>(is_true(left[k]) & is_true(right[k]))); break;
+        case TokenType::Or: BLOCK_APPLY_BINARY(left, right, size, from_bool<T>(is_true(left[k]) | is_true(right[k]))); break;
+        default: break;
+        }
     }
-    catch (std::invalid_argument &err)
+
+    return {std::move(stack.back()), Rori::Math::ErrorKind::None};
+}
+
+template <typename T>
+static auto reduce(const ReductionProgram &__reduction, const T *__values) -> T
+{
+    T lower = execute(__reduction.lower, __values);
+    T upper = execute(__reduction.upper, __values);
+
+    // Outer variable is broadcast to every lane, the bound variable is the last one
+    std::size_t outer_size = __reduction.body.variables.size() - 1;
+    std::vector<T> lanes(__reduction.body.variables.size() * BLOCK_SIZE);
+    for (std::size_t v = 0; v < outer_size; v++)
+        std::fill(lanes.begin() + v * BLOCK_SIZE, lanes.begin() + (v + 1) * BLOCK_SIZE, __values[v]);
+
+    if (__reduction.type == ReductionType::Integral)
     {
-        return {-1, Rori::Math::ErrorKind::ParseIntError};
+        f64 a = value_of(lower), b = value_of(upper);
+        if (!std::isfinite(a) || !std::isfinite(b))
+            return constant<T>(NAN);
+        if (a == b)
+            return constant<T>(0.0L);
+
+        // Fixed panel count so result doesn't depend on the machine, only panel that need refinement run in parallel.
+        // Subdivision budget is shared evenly by the refined panel so oscillating integrand like sin(1/x) still return
+        constexpr std::size_t PANEL_COUNT = 16;
+        constexpr u32 MAX_SUBDIVISION = 4096;
+        constexpr f64 RELATIVE_TOLERANCE = 1e-12;
+        std::vector<T> estimates(PANEL_COUNT);
+        std::vector<f64> errors(PANEL_COUNT);
+        f64 width = (b - a) / PANEL_COUNT;
+        f64 total_estimate = 0;
+
+        for (std::size_t panel = 0; panel < PANEL_COUNT; panel++)
+        {
+            auto [estimate, error] = gauss_kronrod(__reduction.body, lanes, a + width * panel, a + width * (panel + 1));
+            estimates[panel] = estimate;
+            errors[panel] = error;
+            total_estimate += value_of(estimate);
+        }
+
+        f64 tolerance = std::max(RELATIVE_TOLERANCE * std::fabs(total_estimate), 1e-15L) / PANEL_COUNT;
+        std::vector<std::size_t> refine;
+        for (std::size_t panel = 0; panel < PANEL_COUNT; panel++)
+            if (errors[panel] > tolerance)
+                refine.push_back(panel);
+
+        std::size_t workers_size = worker_count(refine.size());
+        bool is_sampled_reduction = is_sampled;
+        run_workers(workers_size, [&](std::size_t worker)
+                    {
+                        SampleScope sample(is_sampled_reduction);
+                        std::vector<T> worker_lanes = lanes;
+                        for (std::size_t r = worker; r < refine.size(); r += workers_size)
+                        {
+                            std::size_t panel = refine[r];
+                            u32 budget = MAX_SUBDIVISION / refine.size();
+                            estimates[panel] = integrate_panel(__reduction.body, worker_lanes, a + width * panel, a + width * (panel + 1), tolerance, 0, budget);
+                        } });
+
+        Pairwise<T, false> result;
+        for (auto &estimate : estimates)
+            result.add(estimate);
+
+        T integral = result.total();
+
+        // Leibniz rule, moving the bound also move the integral
+        if constexpr (std::is_same_v<T, Dual>)
+        {
+            lanes[outer_size * BLOCK_SIZE] = constant<T>(a);
+            lanes[outer_size * BLOCK_SIZE + 1] = constant<T>(b);
+            std::vector<T> stack(__reduction.body.stack_size * BLOCK_SIZE);
+            execute_block(__reduction.body, lane_pointers(lanes).data(), 2, stack.data());
+            integral.derivative += stack[1].value * upper.derivative - stack[0].value * lower.derivative;
+        }
+
+        return integral;
     }
+
+    bool is_product = __reduction.type == ReductionType::Product;
+    f64 first = std::ceil(value_of(lower)), last = std::floor(value_of(upper));
+    if (!std::isfinite(first) || !std::isfinite(last))
+        return constant<T>(NAN);
+    if (last < first)
+        return constant<T>(is_product ? 1.0L : 0.0L);
+
+    // Split the range into block aligned chunk, each worker accumulate its chunk pairwise
+    constexpr u64 PARALLEL_THRESHOLD = 1 << 16;
+    u64 count = static_cast<u64>(last - first) + 1;
+    std::size_t workers_size = count >= PARALLEL_THRESHOLD ? worker_count(count / PARALLEL_THRESHOLD) : 1;
+    u64 chunk = ((count + workers_size - 1) / workers_size + BLOCK_SIZE - 1) / BLOCK_SIZE * BLOCK_SIZE;
+
+    std::vector<T> partial(workers_size, constant<T>(is_product ? 1.0L : 0.0L));
+    bool is_sampled_reduction = is_sampled;
+    run_workers(workers_size, [&](std::size_t worker)
+                {
+                    SampleScope sample(is_sampled_reduction);
+                    Pairwise<T, false> sum;
+                    Pairwise<T, true> product;
+                    std::vector<T> worker_lanes = lanes;
+                    std::vector<T> stack(__reduction.body.stack_size * BLOCK_SIZE);
+                    auto pointers = lane_pointers(worker_lanes);
+                    u64 start = std::min<u64>(worker * chunk, count), end = std::min<u64>(start + chunk, count);
+
+                    for (u64 block = start; block < end; block += BLOCK_SIZE)
+                    {
+                        std::size_t size = std::min<u64>(BLOCK_SIZE, end - block);
+                        for (std::size_t k = 0; k < size; k++)
+                            worker_lanes[outer_size * BLOCK_SIZE + k] = constant<T>(first + static_cast<f64>(block + k));
+
+                        execute_block(__reduction.body, pointers.data(), size, stack.data());
+
+                        for (std::size_t k = 0; k < size; k++)
+                            is_product ? product.add(stack[k]) : sum.add(stack[k]);
+                    }
+
+                    partial[worker] = is_product ? product.total() : sum.total(); });
+
+    Pairwise<T, false> sum;
+    Pairwise<T, true> product;
+    for (auto &value : partial)
+        is_product ? product.add(value) : sum.add(value);
+
+    return is_product ? product.total() : sum.total();
 }
 
+/**
+ * @brief Node and weight of 15 point Gauss-Kronrod rule, odd index is the embedded 7 point Gauss rule
+ */
+static constexpr f64 KRONROD_NODES[8] = {
+    0.991455371120812639206854697526329L, 0.949107912342758524526189684047851L,
+    0.864864423359769072789712788640926L, 0.741531185599394439863864773280788L,
+    0.586087235467691130294144845693013L, 0.405845151377397166906606412076961L,
+    0.207784955007898467600689403773245L, 0.000000000000000000000000000000000L};
+static constexpr f64 KRONROD_WEIGHTS[8] = {
+    0.022935322010529224963732008058970L, 0.063092092629978553290700663189204L,
+    0.104790010322250183839876322541518L, 0.140653259715525918745189590510238L,
+    0.169004726639267902826583426598550L, 0.190350578064785409913256402421014L,
+    0.204432940075298892414161999234649L, 0.209482141084727828012999174891714L};
+static constexpr f64 GAUSS_WEIGHTS[4] = {
+    0.129484966168869693270611432679082L, 0.279705391489276667901467771423780L,
+    0.381830050505118944950369775488975L, 0.417959183673469387755102040816327L};
+
 template <typename T>
-static inline auto pop(std::stack<T> &stack) -> T
+static auto gauss_kronrod(const Rori::Math::Program &__body, std::vector<T> &__lanes, f64 __lower, f64 __upper) -> std::tuple<T, f64>
 {
-    auto temp = stack.top();
-    stack.pop();
-    return temp;
+    f64 center = (__lower + __upper) / 2, half = (__upper - __lower) / 2;
+    T *bound = __lanes.data() + (__body.variables.size() - 1) * BLOCK_SIZE;
+
+    // Every node evaluated as one block, 0..6 is left side, 7..13 is right side and 14 is the center
+    for (std::size_t j = 0; j < 7; j++)
+    {
+        bound[j] = constant<T>(center - half * KRONROD_NODES[j]);
+        bound[j + 7] = constant<T>(center + half * KRONROD_NODES[j]);
+    }
+    bound[14] = constant<T>(center);
+
+    T stack_buffer[BLOCK_SIZE * 4];
+    std::vector<T> heap_stack;
+    T *stack = stack_buffer;
+    if (__body.stack_size > 4)
+    {
+        heap_stack.resize(__body.stack_size * BLOCK_SIZE);
+        stack = heap_stack.data();
+    }
+
+    execute_block(__body, lane_pointers(__lanes).data(), 15, stack);
+
+    T kronrod = constant<T>(KRONROD_WEIGHTS[7]) * stack[14];
+    T gauss = constant<T>(GAUSS_WEIGHTS[3]) * stack[14];
+    for (std::size_t j = 0; j < 7; j++)
+    {
+        T pair = stack[j] + stack[j + 7];
+        kronrod = kronrod + constant<T>(KRONROD_WEIGHTS[j]) * pair;
+        if (j % 2 == 1)
+            gauss = gauss + constant<T>(GAUSS_WEIGHTS[j / 2]) * pair;
+    }
+
+    kronrod = constant<T>(half) * kronrod;
+    gauss = constant<T>(half) * gauss;
+
+    return {kronrod, std::fabs(value_of(kronrod) - value_of(gauss))};
 }
 
-auto Rori::Math::input(std::string &__dst, const char *__msg) -> void
+template <typename T>
+static auto integrate_panel(const Rori::Math::Program &__body, std::vector<T> &__lanes, f64 __lower, f64 __upper, f64 __tolerance, u32 __depth, u32 &__budget) -> T
 {
-    std::cout << __msg;
-    std::getline(std::cin, __dst);
+    constexpr u32 MAX_DEPTH = 48;
+
+    f64 middle = (__lower + __upper) / 2;
+    auto [left, left_error] = gauss_kronrod(__body, __lanes, __lower, middle);
+    auto [right, right_error] = gauss_kronrod(__body, __lanes, middle, __upper);
+
+    if (left_error + right_error <= __tolerance || __depth >= MAX_DEPTH || middle == __lower || middle == __upper)
+        return left + right;
+
+    // Once the budget run out every pending half keep its current estimate
+    if (left_error > __tolerance / 2 && __budget > 0)
+    {
+        __budget--;
+        left = integrate_panel(__body, __lanes, __lower, middle, __tolerance / 2, __depth + 1, __budget);
+    }
+    if (right_error > __tolerance / 2 && __budget > 0)
+    {
+        __budget--;
+        right = integrate_panel(__body, __lanes, middle, __upper, __tolerance / 2, __depth + 1, __budget);
+    }
+
+    return left + right;
 }
 
-auto Rori::Math::print_help() -> void
+static auto find_closing(const std::string &__src, std::size_t __open) -> std::size_t
 {
-    std::cout << "\nSupported Operand\t: '+', '-', '*', '/', '^', '%'\n"
-              << "Supported Function\t: 'sin', 'cos', 'tan', 'acos', 'asin', 'atan', 'sqrt', 'log', 'floor'\n"
-              << "example\t: sin(4*(2+8)^2) it will resulted -0.8509193596\n\n";
+    i32 depth = 0;
+    for (std::size_t i = __open; i < __src.length(); i++)
+    {
+        if (__src[i] == '(' || __src[i] == '[')
+            depth++;
+        else if ((__src[i] == ')' || __src[i] == ']') && --depth == 0)
+            return i;
+    }
+
+    return std::string::npos;
 }
 
-template <typename _InputIterator, typename F>
-static inline auto transform(_InputIterator start, _InputIterator end, _InputIterator dst, std::function<void(F)> lambda) -> void
+static auto split_arguments(const std::string &__src) -> std::vector<std::string>
 {
-    for (; start != end; start++)
+    // Split on top level comma only, nested call or array may have its own comma
+    std::vector<std::string> args;
+    std::size_t start = 0;
+    i32 depth = 0;
+    for (std::size_t i = 0; i <= __src.length(); i++)
     {
-        lambda(*start);
+        if (i < __src.length() && (__src[i] == '(' || __src[i] == '['))
+            depth++;
+        else if (i < __src.length() && (__src[i] == ')' || __src[i] == ']'))
+            depth--;
+        else if (i == __src.length() || (__src[i] == ',' && depth == 0))
+        {
+            args.push_back(__src.substr(start, i - start));
+            start = i + 1;
+        }
     }
+
+    return args;
 }
 
-// Token Class
+static auto compile_reduction(const std::string &__name, const std::string &__args, const std::vector<std::string> &__variables) -> Result<ReductionProgram, Rori::Math::ErrorKind>
+{
+    ReductionProgram reduction = {ReductionType::Sum, {}, {}, {}};
 
-Token::Token(TokenType type, f64 value)
-    : m_type(type), m_value(value) {}
+    auto args = split_arguments(__args);
 
-Token::Token(TokenType type) : m_type(type) {}
+    if (args.size() != 4)
+        return {reduction, Rori::Math::ErrorKind::SyntaxError};
 
-Token::Token(TokenType type, FunctionType func_type) : m_type(type), m_func_type(func_type) {}
+    std::string bound = args[0];
+    bound.erase(0, bound.find_first_not_of(' '));
+    bound.erase(bound.find_last_not_of(' ') + 1);
 
-Token::Token(TokenType type, i32 precedence, bool is_left_associativity)
-    : m_type(type), m_precedence(precedence), m_is_left_associativity(is_left_associativity) {}
+    if (!is_identifier(bound))
+        return {reduction, Rori::Math::ErrorKind::SyntaxError};
 
-const TokenType &Token::get_token() const { return this->m_type; }
-const FunctionType &Token::get_function_type() const { return this->m_func_type; }
-const f64 &Token::get_value() const { return this->m_value; }
-const i32 &Token::get_precedence() const { return this->m_precedence; }
-const bool &Token::is_left_associative() const { return this->m_is_left_associativity; }
+    if (__name == "prod")
+        reduction.type = ReductionType::Product;
+    else if (__name == "integrate")
+        reduction.type = ReductionType::Integral;
 
-std::ostream &operator<<(std::ostream &os, const Token &token)
-{
-    if (token.m_type == TokenType::Function)
-    {
-        IF_TRUE_LBITSHIFT_OS(os, token.m_func_type == FunctionType::Sin, "sin");
-        IF_TRUE_LBITSHIFT_OS(os, token.m_func_type == FunctionType::Cos, "cos");
-        IF_TRUE_LBITSHIFT_OS(os, token.m_func_type == FunctionType::Tan, "tan");
-        IF_TRUE_LBITSHIFT_OS(os, token.m_func_type == FunctionType::Asin, "Asin");
-        IF_TRUE_LBITSHIFT_OS(os, token.m_func_type == FunctionType::Acos, "Acos");
-        IF_TRUE_LBITSHIFT_OS(os, token.m_func_type == FunctionType::Atan, "Atan");
-        IF_TRUE_LBITSHIFT_OS(os, token.m_func_type == FunctionType::Sqrt, "Sqrt");
-        IF_TRUE_LBITSHIFT_OS(os, token.m_func_type == FunctionType::Log, "Log");
-        IF_TRUE_LBITSHIFT_OS(os, token.m_func_type == FunctionType::Floor, "Floor");
-    }
+    std::vector<std::string> body_variables = __variables;
+    body_variables.push_back(bound);
 
-    IF_TRUE_LBITSHIFT_OS(os, token.m_type == TokenType::Plus, "+");
-    IF_TRUE_LBITSHIFT_OS(os, token.m_type == TokenType::Subtract, "-");
-    IF_TRUE_LBITSHIFT_OS(os, token.m_type == TokenType::Multiply, "*");
-    IF_TRUE_LBITSHIFT_OS(os, token.m_type == TokenType::Divide, "/");
-    IF_TRUE_LBITSHIFT_OS(os, token.m_type == TokenType::PowerOperator, "^");
-    IF_TRUE_LBITSHIFT_OS(os, token.m_type == TokenType::OpenParenthesis, "(");
-    IF_TRUE_LBITSHIFT_OS(os, token.m_type == TokenType::CloseParenthesis, ")");
+    Rori::Math::ErrorKind err;
+    std::tie(reduction.lower, err) = compile_program(args[1], __variables);
+    if (err != Rori::Math::ErrorKind::None)
+        return {reduction, err};
 
-    return os;
-}
+    std::tie(reduction.upper, err) = compile_program(args[2], __variables);
+    if (err != Rori::Math::ErrorKind::None)
+        return {reduction, err};
 
-// Math Solver Class
+    std::tie(reduction.body, err) = compile_program(args[3], body_variables);
+    if (err != Rori::Math::ErrorKind::None)
+        return {reduction, err};
 
-auto Rori::Math::MathSolver::evaluate(const std::string &__src) -> Result<f64, Rori::Math::ErrorKind>
+    bool is_scalar = reduction.lower.length == 1 && reduction.upper.length == 1 && reduction.body.length == 1;
+
+    return {reduction, is_scalar ? Rori::Math::ErrorKind::None : Rori::Math::ErrorKind::ShapeMismatch};
+}
+
+static auto compile_program(const std::string &__src, const std::vector<std::string> &__variables) -> Result<Rori::Math::Program, Rori::Math::ErrorKind>
 {
-    auto [tokens, err] = tokenize(__src);
+    Rori::Math::Program program = {{}, __variables, 0, {}, {}, {}, 1};
+
+    auto [tokens, err] = tokenize(__src, program);
 
     if (err != Rori::Math::ErrorKind::None)
-        return {-1, err};
+        return {program, err};
 
-    auto [res, err2] = parse(tokens);
+    auto [code, err2] = parse(tokens);
 
     if (err2 != Rori::Math::ErrorKind::None)
-        return {-1, err2};
+        return {program, err2};
 
-    if (res.size() == 1 && res.top().get_token() == TokenType::Number)
-        return {pop(res).get_value(), Rori::Math::ErrorKind::None};
+    // Validate operand count and array length once so execution doesn't need to check it,
+    // length is computed as if every variable is bound to a single value
+    std::vector<std::size_t> lengths;
+    for (auto &token : code)
+    {
+        std::size_t depth = lengths.size();
+        switch (token.get_token())
+        {
+        case TokenType::Number:
+        case TokenType::Variable:
+        case TokenType::Reduction:
+            lengths.push_back(1);
+            break;
+        case TokenType::ArrayLiteral:
+        {
+            std::size_t length = 0;
+            for (auto &element : program.arrays[token.get_slot()])
+                length += element.length;
 
-    auto err3 = calculate(res);
+            lengths.push_back(length);
+            break;
+        }
+        case TokenType::Conditional:
+        {
+            auto &conditional = program.conditionals[token.get_slot()];
+            std::size_t length = std::max({conditional.condition.length, conditional.then.length, conditional.otherwise.length});
+            for (auto *branch : {&conditional.condition, &conditional.then, &conditional.otherwise})
+                if (branch->length != 1 && branch->length != length)
+                    return {program, Rori::Math::ErrorKind::ShapeMismatch};
+
+            // execute_block run the three program one slot apart on top of the current stack
+            std::size_t scratch = std::max({conditional.condition.stack_size, conditional.then.stack_size + 1, conditional.otherwise.stack_size + 2});
+            program.stack_size = std::max(program.stack_size, depth + scratch);
+            lengths.push_back(length);
+            break;
+        }
+        case TokenType::Function:
+            CHECK_OPERAND_COUNT(depth, 1, program);
+            if (token.get_function_type() >= FunctionType::ArraySum)
+                lengths.back() = 1;
+            break;
+        case TokenType::OpenParenthesis:
+        case TokenType::CloseParenthesis:
+            return {program, Rori::Math::ErrorKind::SyntaxError};
+        default:
+        {
+            CHECK_OPERAND_COUNT(depth, 2, program);
+            std::size_t rhs = lengths.back();
+            lengths.pop_back();
 
-    if (err3 != Rori::Math::ErrorKind::None)
-        return {-1, err3};
+            if (rhs != lengths.back() && rhs != 1 && lengths.back() != 1)
+                return {program, Rori::Math::ErrorKind::ShapeMismatch};
 
-    if (res.size() != 1)
-        return {-1, Rori::Math::ErrorKind::SyntaxError};
+            lengths.back() = std::max(rhs, lengths.back());
+            break;
+        }
+        }
+
+        program.stack_size = std::max(program.stack_size, lengths.size());
+    }
 
-    return {res.top().get_value(), Rori::Math::ErrorKind::None};
+    if (lengths.size() != 1)
+        return {program, Rori::Math::ErrorKind::SyntaxError};
+
+    program.code = insert_jumps(fold_constants(code));
+    program.length = lengths.back();
+    program.is_exact = is_exact_program(program);
+
+    return {program, Rori::Math::ErrorKind::None};
 }
 
-static auto calculate(std::stack<Token> &__src) -> Rori::Math::ErrorKind
+static auto fold_constants(const std::vector<Token> &__code) -> std::vector<Token>
 {
-    CHECK_IF_EMPTY(__src, Rori::Math::ErrorKind::SyntaxError);
-    auto op1 = pop(__src);
+    // Operator right after two exact literal is evaluated once here, so "123456789 * 3 + x" only add at runtime
+    std::vector<Token> code;
+    for (auto &token : __code)
+    {
+        std::size_t size = code.size();
+        bool is_foldable = is_exact_operator(token.get_token()) && size >= 2 &&
+                           code[size - 2].get_token() == TokenType::Number && code[size - 2].get_exact().denominator != 0 &&
+                           code[size - 1].get_token() == TokenType::Number && code[size - 1].get_exact().denominator != 0;
+
+        Rational folded = is_foldable ? apply_exact(token.get_token(), code[size - 2].get_exact(), code[size - 1].get_exact()) : Rational{0, 0};
+        if (folded.denominator == 0)
+        {
+            code.push_back(token);
+            continue;
+        }
 
-    CHECK_IF_EMPTY(__src, Rori::Math::ErrorKind::SyntaxError);
-    if (__src.top().get_token() != TokenType::Number)
-        calculate(__src);
+        code.pop_back();
+        code.back() = CREATE_NUMBER_TOKEN(value_of(folded), folded);
+    }
 
-    CHECK_IF_EMPTY(__src, Rori::Math::ErrorKind::SyntaxError);
-    auto op2 = pop(__src);
+    return code;
+}
 
-    if (op1.get_token() == TokenType::Function)
+static auto is_exact_program(const Rori::Math::Program &__program) -> bool
+{
+    for (auto &token : __program.code)
     {
-        PUSH_RESOLVED_FUNCTION_TOKEN_STACK(__src, op1, FunctionType::Sin, std::sin(op2.get_value()));
-        PUSH_RESOLVED_FUNCTION_TOKEN_STACK(__src, op1, FunctionType::Cos, std::cos(op2.get_value()));
-        PUSH_RESOLVED_FUNCTION_TOKEN_STACK(__src, op1, FunctionType::Tan, std::tan(op2.get_value()));
-        PUSH_RESOLVED_FUNCTION_TOKEN_STACK(__src, op1, FunctionType::Acos, std::acos(op2.get_value()));
-        PUSH_RESOLVED_FUNCTION_TOKEN_STACK(__src, op1, FunctionType::Asin, std::asin(op2.get_value()));
-        PUSH_RESOLVED_FUNCTION_TOKEN_STACK(__src, op1, FunctionType::Atan, std::atan(op2.get_value()));
-        PUSH_RESOLVED_FUNCTION_TOKEN_STACK(__src, op1, FunctionType::Sqrt, std::sqrt(op2.get_value()));
-        PUSH_RESOLVED_FUNCTION_TOKEN_STACK(__src, op1, FunctionType::Log, std::log(op2.get_value()));
-        PUSH_RESOLVED_FUNCTION_TOKEN_STACK(__src, op1, FunctionType::Floor, std::floor(op2.get_value()));
+        switch (token.get_token())
+        {
+        case TokenType::Number:
+            if (token.get_exact().denominator == 0)
+                return false;
+            break;
+        case TokenType::Variable:
+        case TokenType::JumpIfFalse:
+        case TokenType::JumpIfTrue:
+            break;
+        case TokenType::Conditional:
+        {
+            auto &conditional = __program.conditionals[token.get_slot()];
+            if (!conditional.condition.is_exact || !conditional.then.is_exact || !conditional.otherwise.is_exact)
+                return false;
+            break;
+        }
+        default:
+            if (!is_exact_operator(token.get_token()))
+                return false;
+            break;
+        }
+    }
 
-        return Rori::Math::ErrorKind::SyntaxError;
+    return true;
+}
+
+static auto compile_conditional(const std::string &__args, const std::vector<std::string> &__variables) -> Result<ConditionalProgram, Rori::Math::ErrorKind>
+{
+    ConditionalProgram conditional;
+
+    auto args = split_arguments(__args);
+
+    if (args.size() != 3)
+        return {conditional, Rori::Math::ErrorKind::SyntaxError};
+
+    Rori::Math::ErrorKind err;
+    std::tie(conditional.condition, err) = compile_program(args[0], __variables);
+    if (err != Rori::Math::ErrorKind::None)
+        return {conditional, err};
+
+    std::tie(conditional.then, err) = compile_program(args[1], __variables);
+    if (err != Rori::Math::ErrorKind::None)
+        return {conditional, err};
+
+    std::tie(conditional.otherwise, err) = compile_program(args[2], __variables);
+
+    return {conditional, err};
+}
+
+static auto insert_jumps(const std::vector<Token> &__code) -> std::vector<Token>
+{
+    // Right side of "and" / "or" is the shortest run of code ending right before it that push exactly one value,
+    // a jump placed at its start let the scalar evaluator skip it once the left side decide the result
+    std::vector<std::size_t> jumps_before(__code.size() + 1, 0);
+    std::vector<std::tuple<std::size_t, std::size_t>> jumps;
+    for (std::size_t i = 0; i < __code.size(); i++)
+    {
+        if (__code[i].get_token() != TokenType::And && __code[i].get_token() != TokenType::Or)
+            continue;
+
+        i64 pushed = 0;
+        std::size_t start = i;
+        while (pushed != 1)
+        {
+            switch (__code[--start].get_token())
+            {
+            case TokenType::Number:
+            case TokenType::Variable:
+            case TokenType::Reduction:
+            case TokenType::ArrayLiteral:
+            case TokenType::Conditional:
+                pushed++;
+                break;
+            case TokenType::Function:
+                break;
+            default:
+                pushed--;
+                break;
+            }
+        }
+
+        jumps.push_back({start, i});
+        jumps_before[start + 1]++;
     }
 
-    CHECK_IF_EMPTY(__src, Rori::Math::ErrorKind::SyntaxError);
-    if (__src.top().get_token() != TokenType::Number)
-        calculate(__src);
+    if (jumps.empty())
+        return __code;
 
-    CHECK_IF_EMPTY(__src, Rori::Math::ErrorKind::SyntaxError);
-    auto op3 = pop(__src);
+    // jumps_before[i] become the amount of jump inserted before original index i
+    for (std::size_t i = 1; i <= __code.size(); i++)
+        jumps_before[i] += jumps_before[i - 1];
 
-    PUSH_RESOLVE_OP_TOKEN_STACK(__src, op1, TokenType::Plus, op3.get_value() + op2.get_value());
-    PUSH_RESOLVE_OP_TOKEN_STACK(__src, op1, TokenType::Subtract, op3.get_value() - op2.get_value());
-    PUSH_RESOLVE_OP_TOKEN_STACK(__src, op1, TokenType::Multiply, op3.get_value() * op2.get_value());
-    PUSH_RESOLVE_OP_TOKEN_STACK(__src, op1, TokenType::Divide, op3.get_value() / op2.get_value());
-    PUSH_RESOLVE_OP_TOKEN_STACK(__src, op1, TokenType::PowerOperator, std::pow(op3.get_value(), op2.get_value()));
-    PUSH_RESOLVE_OP_TOKEN_STACK(__src, op1, TokenType::Modulo, std::fmod(op3.get_value(), op2.get_value()));
+    std::sort(jumps.begin(), jumps.end());
 
-    return Rori::Math::ErrorKind::None;
+    std::vector<Token> code;
+    auto next_jump = jumps.begin();
+    for (std::size_t i = 0; i < __code.size(); i++)
+    {
+        for (; next_jump != jumps.end() && std::get<0>(*next_jump) == i; next_jump++)
+        {
+            std::size_t target = std::get<1>(*next_jump);
+            TokenType type = __code[target].get_token() == TokenType::And ? TokenType::JumpIfFalse : TokenType::JumpIfTrue;
+            code.push_back(Token(type, static_cast<u32>(target + jumps_before[target + 1])));
+        }
+
+        code.push_back(__code[i]);
+    }
+
+    return code;
 }
 
-static auto tokenize(const std::string &__src) -> Result<std::vector<Token>, Rori::Math::ErrorKind>
+static auto tokenize(const std::string &__src, Rori::Math::Program &__program) -> Result<std::vector<Token>, Rori::Math::ErrorKind>
 {
+    const std::vector<std::string> &variables = __program.variables;
     std::vector<std::string> tokenized;
+    std::vector<Token> tokens;
+
+    // Reduction and array literal is compiled while scanning, remember where they are on tokenized
+    std::vector<std::tuple<std::size_t, Token>> captured;
 
     std::size_t i = 0;
     while (i < __src.length())
@@ -191,16 +1976,97 @@ static auto tokenize(const std::string &__src) -> Result<std::vector<Token>, Ror
             continue;
         }
 
-        if (std::isalpha(__src[i]))
+        if (std::isalpha(__src[i]) || __src[i] == '_')
         {
             std::size_t start = i;
-            while (std::isalpha(__src[i]))
+            while (std::isalnum(__src[i]) || __src[i] == '_')
                 i++;
 
+            std::string name = __src.substr(start, i - start);
+            transform(name.begin(), name.end(), name.begin(), ::tolower);
+
+            bool is_variable = std::find(variables.begin(), variables.end(), __src.substr(start, i - start)) != variables.end();
+            if (!is_variable && name == "if")
+            {
+                std::size_t open = i;
+                while (__src[open] == ' ')
+                    open++;
+
+                std::size_t close = __src[open] == '(' ? find_closing(__src, open) : std::string::npos;
+                if (close == std::string::npos)
+                    return {tokens, Rori::Math::ErrorKind::SyntaxError};
+
+                auto [conditional, err] = compile_conditional(__src.substr(open + 1, close - open - 1), variables);
+
+                if (err != Rori::Math::ErrorKind::None)
+                    return {tokens, err};
+
+                captured.push_back({tokenized.size(), Token(TokenType::Conditional, static_cast<u32>(__program.conditionals.size()))});
+                __program.conditionals.push_back(std::move(conditional));
+                tokenized.push_back(name);
+                i = close + 1;
+                continue;
+            }
+
+            if (!is_variable && (name == "sum" || name == "prod" || name == "integrate"))
+            {
+                // Reduction argument is compiled on its own, so capture everything until the matching parenthesis
+                std::size_t open = i;
+                while (__src[open] == ' ')
+                    open++;
+
+                std::size_t close = __src[open] == '(' ? find_closing(__src, open) : std::string::npos;
+                if (close == std::string::npos)
+                    return {tokens, Rori::Math::ErrorKind::SyntaxError};
+
+                // sum(array) with single argument is a function
+                std::string args = __src.substr(open + 1, close - open - 1);
+                if (name == "sum" && split_arguments(args).size() == 1)
+                {
+                    tokenized.push_back(name);
+                    continue;
+                }
+
+                auto [reduction, err] = compile_reduction(name, args, variables);
+
+                if (err != Rori::Math::ErrorKind::None)
+                    return {tokens, err};
+
+                captured.push_back({tokenized.size(), Token(TokenType::Reduction, static_cast<u32>(__program.reductions.size()))});
+                __program.reductions.push_back(std::move(reduction));
+                tokenized.push_back(name);
+                i = close + 1;
+                continue;
+            }
+
             tokenized.push_back(__src.substr(start, i - start));
             continue;
         }
 
+        if (__src[i] == '[')
+        {
+            std::size_t close = find_closing(__src, i);
+            if (close == std::string::npos)
+                return {tokens, Rori::Math::ErrorKind::SyntaxError};
+
+            std::vector<Rori::Math::Program> elements;
+            for (auto &element : split_arguments(__src.substr(i + 1, close - i - 1)))
+            {
+                auto [program, err] = compile_program(element, variables);
+
+                if (err != Rori::Math::ErrorKind::None)
+                    return {tokens, err};
+
+                elements.push_back(std::move(program));
+            }
+
+            captured.push_back({tokenized.size(), Token(TokenType::ArrayLiteral, static_cast<u32>(__program.arrays.size()))});
+            __program.arrays.push_back(std::move(elements));
+            tokenized.push_back(__src.substr(i, close - i + 1));
+            i = close + 1;
+            continue;
+        }
+
         if (__src[i] == '(')
         {
             tokenized.push_back(__src.substr(i, 1));
@@ -212,28 +2078,30 @@ static auto tokenize(const std::string &__src) -> Result<std::vector<Token>, Ror
                 i++;
 
                 PARSE_INT_FROM_STR(__src, start, i);
-
-                tokenized.push_back(__src.substr(start, i - start));
+                PUSH_NEGATED_STR(tokenized, __src, start, i);
                 continue;
             }
             continue;
         }
 
-        if (__src[i] == '-' && i == 0)
+        // Comparison and logical operator bind looser than '*', so negation right after them is safe
+        static const std::vector<std::string> COMPARISONS = {"<", "<=", ">", ">=", "==", "!=", "and", "or"};
+        bool is_after_comparison = !tokenized.empty() && std::find(COMPARISONS.begin(), COMPARISONS.end(), tokenized.back()) != COMPARISONS.end();
+        if (__src[i] == '-' && (tokenized.empty() || is_after_comparison))
         {
             std::size_t start = i;
             i++;
 
             PARSE_INT_FROM_STR(__src, start, i);
-
-            tokenized.push_back(__src.substr(start, i - start));
+            PUSH_NEGATED_STR(tokenized, __src, start, i);
             continue;
         }
 
         if (!std::isdigit(__src[i]))
         {
-            tokenized.push_back(__src.substr(i, 1));
-            i++;
+            bool is_two_character = (__src[i] == '<' || __src[i] == '>' || __src[i] == '=' || __src[i] == '!') && i + 1 < __src.length() && __src[i + 1] == '=';
+            tokenized.push_back(__src.substr(i, is_two_character ? 2 : 1));
+            i += is_two_character ? 2 : 1;
             continue;
         }
 
@@ -249,13 +2117,25 @@ static auto tokenize(const std::string &__src) -> Result<std::vector<Token>, Ror
         i++;
     }
 
-    std::vector<Token> tokens;
-    for (auto token : tokenized)
+    auto next_captured = captured.begin();
+    for (std::size_t index = 0; index < tokenized.size(); index++)
     {
+        if (next_captured != captured.end() && std::get<0>(*next_captured) == index)
+        {
+            tokens.push_back(std::get<1>(*next_captured++));
+            continue;
+        }
+
+        std::string token = tokenized[index];
+
+        // Search from the back so bound variable of reduction shadow the outer one
+        auto variable = std::find(variables.rbegin(), variables.rend(), token);
+        IF_TRUE_PUSH_VEC_N_CONTINUE(tokens, variable != variables.rend(), CREATE_VARIABLE_TOKEN(variables.rend() - variable - 1));
+
         auto [num, err] = parse_int(token);
         if (err != Rori::Math::ErrorKind::ParseIntError)
         {
-            tokens.push_back(CREATE_NUMBER_TOKEN(num));
+            tokens.push_back(CREATE_NUMBER_TOKEN(num, parse_rational(token)));
             continue;
         }
 
@@ -267,6 +2147,14 @@ static auto tokenize(const std::string &__src) -> Result<std::vector<Token>, Ror
         IF_TRUE_PUSH_VEC_N_CONTINUE(tokens, token == "/", Token(TokenType::Divide, 2, true));
         IF_TRUE_PUSH_VEC_N_CONTINUE(tokens, token == "%", Token(TokenType::Modulo, 2, true));
         IF_TRUE_PUSH_VEC_N_CONTINUE(tokens, token == "^", Token(TokenType::PowerOperator, 3, false));
+        IF_TRUE_PUSH_VEC_N_CONTINUE(tokens, token == "<", Token(TokenType::Less, 0, true));
+        IF_TRUE_PUSH_VEC_N_CONTINUE(tokens, token == "<=", Token(TokenType::LessEqual, 0, true));
+        IF_TRUE_PUSH_VEC_N_CONTINUE(tokens, token == ">", Token(TokenType::Greater, 0, true));
+        IF_TRUE_PUSH_VEC_N_CONTINUE(tokens, token == ">=", Token(TokenType::GreaterEqual, 0, true));
+        IF_TRUE_PUSH_VEC_N_CONTINUE(tokens, token == "==", Token(TokenType::Equal, 0, true));
+        IF_TRUE_PUSH_VEC_N_CONTINUE(tokens, token == "!=", Token(TokenType::NotEqual, 0, true));
+        IF_TRUE_PUSH_VEC_N_CONTINUE(tokens, token == "and", Token(TokenType::And, -1, true));
+        IF_TRUE_PUSH_VEC_N_CONTINUE(tokens, token == "or", Token(TokenType::Or, -2, true));
         IF_TRUE_PUSH_VEC_N_CONTINUE(tokens, token == "(", Token(TokenType::OpenParenthesis));
         IF_TRUE_PUSH_VEC_N_CONTINUE(tokens, token == ")", Token(TokenType::CloseParenthesis));
         IF_TRUE_PUSH_VEC_N_CONTINUE(tokens, token == "sin", Token(TokenType::Function, FunctionType::Sin));
@@ -278,6 +2166,10 @@ static auto tokenize(const std::string &__src) -> Result<std::vector<Token>, Ror
         IF_TRUE_PUSH_VEC_N_CONTINUE(tokens, token == "sqrt", Token(TokenType::Function, FunctionType::Sqrt));
         IF_TRUE_PUSH_VEC_N_CONTINUE(tokens, token == "log", Token(TokenType::Function, FunctionType::Log));
         IF_TRUE_PUSH_VEC_N_CONTINUE(tokens, token == "floor", Token(TokenType::Function, FunctionType::Floor));
+        IF_TRUE_PUSH_VEC_N_CONTINUE(tokens, token == "sum", Token(TokenType::Function, FunctionType::ArraySum));
+        IF_TRUE_PUSH_VEC_N_CONTINUE(tokens, token == "mean", Token(TokenType::Function, FunctionType::ArrayMean));
+        IF_TRUE_PUSH_VEC_N_CONTINUE(tokens, token == "min", Token(TokenType::Function, FunctionType::ArrayMin));
+        IF_TRUE_PUSH_VEC_N_CONTINUE(tokens, token == "max", Token(TokenType::Function, FunctionType::ArrayMax));
 
         return {tokens, Rori::Math::ErrorKind::SyntaxError};
     }
@@ -285,17 +2177,20 @@ static auto tokenize(const std::string &__src) -> Result<std::vector<Token>, Ror
     return {tokens, Rori::Math::ErrorKind::None};
 }
 
-static auto parse(const std::vector<Token> &__src) -> Result<std::stack<Token>, Rori::Math::ErrorKind>
+static auto parse(const std::vector<Token> &__src) -> Result<std::vector<Token>, Rori::Math::ErrorKind>
 {
     std::stack<Token> operator_stack;
-    std::stack<Token> output;
+    std::vector<Token> output;
     i32 parenthesis_count = 0;
 
     for (auto &token : __src)
     {
-        if (token.get_token() == TokenType::Number)
+        bool is_operand = token.get_token() == TokenType::Number || token.get_token() == TokenType::Variable ||
+                          token.get_token() == TokenType::Reduction || token.get_token() == TokenType::ArrayLiteral ||
+                          token.get_token() == TokenType::Conditional;
+        if (is_operand)
         {
-            output.push(token);
+            output.push_back(token);
             continue;
         }
 
@@ -317,7 +2212,7 @@ static auto parse(const std::vector<Token> &__src) -> Result<std::stack<Token>,
             {
                 if (operator_stack.top().get_token() != TokenType::OpenParenthesis)
                 {
-                    output.push(pop(operator_stack));
+                    output.push_back(pop(operator_stack));
                 }
                 else
                 {
@@ -326,6 +2221,10 @@ static auto parse(const std::vector<Token> &__src) -> Result<std::stack<Token>,
                 }
             }
 
+            // Parenthesis right after function is the function argument
+            if (!operator_stack.empty() && operator_stack.top().get_token() == TokenType::Function)
+                output.push_back(pop(operator_stack));
+
             continue;
         }
 
@@ -336,7 +2235,7 @@ static auto parse(const std::vector<Token> &__src) -> Result<std::stack<Token>,
             bool is_lf_associative_and_equal_precedence = token.get_precedence() == operator_stack.top().get_precedence() && token.is_left_associative();
 
             if (is_top_operator_stack_openparenthesis && (is_token_less_than_operator_stack_top || is_lf_associative_and_equal_precedence))
-                output.push(pop(operator_stack));
+                output.push_back(pop(operator_stack));
             else
                 break;
         }
@@ -345,7 +2244,7 @@ static auto parse(const std::vector<Token> &__src) -> Result<std::stack<Token>,
     }
 
     while (!operator_stack.empty())
-        output.push(pop(operator_stack));
+        output.push_back(pop(operator_stack));
 
     if (parenthesis_count != 0)
         return {output, Rori::Math::ErrorKind::SyntaxError};
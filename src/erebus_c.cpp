@@ -0,0 +1,96 @@
+/**
+ * @file erebus_c.cpp
+ * @author UnknownRori (68576836+UnknownRori@users.noreply.github.com)
+ * @brief Implementation of the C ABI, exception never cross the boundary
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include <new>
+#include "../include/erebus.h"
+#include "../include/erebus.hpp"
+
+struct erebus_solver
+{
+    Rori::Math::MathSolver solver;
+};
+
+struct erebus_expression
+{
+    Rori::Math::Expression expression;
+    std::size_t variable_count;
+};
+
+erebus_solver *erebus_solver_create(void)
+{
+    return new (std::nothrow) erebus_solver();
+}
+
+void erebus_solver_destroy(erebus_solver *solver)
+{
+    delete solver;
+}
+
+erebus_error erebus_compile(erebus_solver *solver, const char *src, const char *const *variables, size_t variable_count, erebus_expression **out)
+{
+    if (solver == nullptr || src == nullptr || out == nullptr || (variables == nullptr && variable_count != 0))
+        return EREBUS_INTERNAL_ERROR;
+
+    try
+    {
+        std::vector<std::string> names(variables, variables + variable_count);
+        auto [expression, err] = solver->solver.compile(src, names);
+
+        if (err != Rori::Math::ErrorKind::None)
+            return static_cast<erebus_error>(err);
+
+        *out = new erebus_expression{expression, variable_count};
+        return EREBUS_NONE;
+    }
+    catch (...)
+    {
+        return EREBUS_INTERNAL_ERROR;
+    }
+}
+
+void erebus_expression_destroy(erebus_expression *expression)
+{
+    delete expression;
+}
+
+erebus_error erebus_evaluate(const erebus_expression *expression, const double *values, double *out)
+{
+    if (expression == nullptr || out == nullptr || (values == nullptr && expression->variable_count != 0))
+        return EREBUS_INTERNAL_ERROR;
+
+    try
+    {
+        std::vector<f64> bound(values, values + expression->variable_count);
+        auto [result, err] = expression->expression.evaluate(bound);
+
+        *out = static_cast<double>(result);
+        return static_cast<erebus_error>(err);
+    }
+    catch (...)
+    {
+        return EREBUS_INTERNAL_ERROR;
+    }
+}
+
+erebus_error erebus_evaluate_batch(const erebus_expression *expression, const double *const *columns, size_t count, double *out)
+{
+    if (expression == nullptr || (out == nullptr && count != 0) || (columns == nullptr && expression->variable_count != 0))
+        return EREBUS_INTERNAL_ERROR;
+
+    try
+    {
+        return static_cast<erebus_error>(expression->expression.evaluate_batch(columns, count, out));
+    }
+    catch (...)
+    {
+        return EREBUS_INTERNAL_ERROR;
+    }
+}
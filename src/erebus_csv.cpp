@@ -0,0 +1,330 @@
+/**
+ * @file erebus_csv.cpp
+ * @author UnknownRori (68576836+UnknownRori@users.noreply.github.com)
+ * @brief Streaming CSV evaluation, every formula is evaluated per row with the header as variable name
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include <charconv>
+#include <cstring>
+#include <thread>
+#include <algorithm>
+#include <cctype>
+#include "../include/erebus.hpp"
+#include "../include/workers.hpp"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/**
+ * @brief Read only memory mapped file, data is nullptr when the file can't be mapped
+ *
+ */
+class MappedFile
+{
+private:
+    const char *m_data = nullptr;
+    std::size_t m_size = 0;
+#ifdef _WIN32
+    HANDLE m_file = INVALID_HANDLE_VALUE;
+    HANDLE m_mapping = nullptr;
+#endif
+
+public:
+    MappedFile(const std::string &path)
+    {
+#ifdef _WIN32
+        this->m_file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        LARGE_INTEGER size;
+        if (this->m_file == INVALID_HANDLE_VALUE || !GetFileSizeEx(this->m_file, &size) || size.QuadPart == 0)
+            return;
+
+        this->m_mapping = CreateFileMappingA(this->m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (this->m_mapping == nullptr)
+            return;
+
+        this->m_data = static_cast<const char *>(MapViewOfFile(this->m_mapping, FILE_MAP_READ, 0, 0, 0));
+        this->m_size = this->m_data ? static_cast<std::size_t>(size.QuadPart) : 0;
+#else
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            return;
+
+        struct stat info;
+        if (fstat(fd, &info) == 0 && info.st_size > 0)
+        {
+            void *data = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (data != MAP_FAILED)
+            {
+                madvise(data, info.st_size, MADV_SEQUENTIAL);
+                this->m_data = static_cast<const char *>(data);
+                this->m_size = info.st_size;
+            }
+        }
+
+        close(fd);
+#endif
+    }
+
+    ~MappedFile()
+    {
+#ifdef _WIN32
+        if (this->m_data)
+            UnmapViewOfFile(this->m_data);
+        if (this->m_mapping)
+            CloseHandle(this->m_mapping);
+        if (this->m_file != INVALID_HANDLE_VALUE)
+            CloseHandle(this->m_file);
+#else
+        if (this->m_data)
+            munmap(const_cast<char *>(this->m_data), this->m_size);
+#endif
+    }
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    const char *data() const { return this->m_data; }
+    std::size_t size() const { return this->m_size; }
+};
+
+/**
+ * @brief Rows handled by one worker at once, parsed column and output of a chunk is all that stay in memory
+ *
+ */
+constexpr std::size_t CHUNK_ROWS = 8192;
+
+/**
+ * @brief Line without the trailing '\r'
+ *
+ */
+static inline auto line_end(const char *__start, const char *__end) -> const char *
+{
+    if (__start >= __end)
+        return __end;
+
+    const char *newline = static_cast<const char *>(std::memchr(__start, '\n', __end - __start));
+    return newline ? newline : __end;
+}
+
+static inline auto trim_line(const char *__start, const char *__end) -> const char *
+{
+    return __end > __start && __end[-1] == '\r' ? __end - 1 : __end;
+}
+
+/**
+ * @brief Split single CSV line into field, quote is stripped but "" escape is kept as is
+ *
+ */
+static auto split_fields(const char *__start, const char *__end, std::vector<std::string_view> &__fields) -> void
+{
+    __fields.clear();
+    const char *cursor = __start;
+    while (true)
+    {
+        while (cursor < __end && *cursor == ' ')
+            cursor++;
+
+        const char *field_start = cursor, *field_end;
+        if (cursor < __end && *cursor == '"')
+        {
+            field_start = ++cursor;
+            while (cursor < __end && !(*cursor == '"' && (cursor + 1 == __end || cursor[1] != '"')))
+                cursor += *cursor == '"' ? 2 : 1;
+
+            field_end = cursor;
+            cursor = cursor < __end ? static_cast<const char *>(std::memchr(cursor, ',', __end - cursor)) : nullptr;
+        }
+        else
+        {
+            cursor = cursor < __end ? static_cast<const char *>(std::memchr(cursor, ',', __end - cursor)) : nullptr;
+            field_end = cursor ? cursor : __end;
+            while (field_end > field_start && field_end[-1] == ' ')
+                field_end--;
+        }
+
+        __fields.emplace_back(field_start, field_end - field_start);
+        if (!cursor)
+            return;
+
+        cursor++;
+    }
+}
+
+/**
+ * @brief Only header that look like identifier is bound, numeric header like pandas index would shadow literal in every formula
+ *
+ */
+static auto is_identifier(std::string_view __name) -> bool
+{
+    return !__name.empty() && (std::isalpha(__name[0]) || __name[0] == '_') &&
+           std::all_of(__name.begin(), __name.end(), [](char c)
+                       { return std::isalnum(c) || c == '_'; });
+}
+
+/**
+ * @brief Parse, evaluate and format one chunk of row into __output, __bound hold the column index of every variable
+ *
+ */
+static auto evaluate_chunk(const char *__start, const char *__end, const std::vector<std::size_t> &__bound, const std::vector<Rori::Math::Expression> &__expressions, std::string &__output) -> Rori::Math::ErrorKind
+{
+    std::vector<std::tuple<const char *, const char *>> rows;
+    for (const char *cursor = __start; cursor < __end;)
+    {
+        const char *end = line_end(cursor, __end);
+        const char *trimmed = trim_line(cursor, end);
+        if (trimmed != cursor)
+            rows.push_back({cursor, trimmed});
+
+        cursor = end + 1;
+    }
+
+    // Column major so every formula can be evaluated over contiguous buffer
+    std::vector<std::vector<f32>> columns(__bound.size(), std::vector<f32>(rows.size(), NAN));
+    std::vector<std::string_view> fields;
+    for (std::size_t row = 0; row < rows.size(); row++)
+    {
+        split_fields(std::get<0>(rows[row]), std::get<1>(rows[row]), fields);
+        for (std::size_t column = 0; column < __bound.size(); column++)
+        {
+            if (__bound[column] >= fields.size())
+                continue;
+
+            const char *first = fields[__bound[column]].data(), *last = first + fields[__bound[column]].size();
+            if (first != last && *first == '+')
+                first++;
+
+            f32 value;
+            auto [end, err] = std::from_chars(first, last, value);
+            if (err == std::errc() && end == last)
+                columns[column][row] = value;
+        }
+    }
+
+    std::vector<const f32 *> pointers(__bound.size());
+    for (std::size_t column = 0; column < __bound.size(); column++)
+        pointers[column] = columns[column].data();
+
+    std::vector<std::vector<f32>> results(__expressions.size(), std::vector<f32>(rows.size()));
+    for (std::size_t formula = 0; formula < __expressions.size(); formula++)
+    {
+        auto err = __expressions[formula].evaluate_batch(pointers.data(), rows.size(), results[formula].data());
+        if (err != Rori::Math::ErrorKind::None)
+            return err;
+    }
+
+    char number[64];
+    __output.clear();
+    for (std::size_t row = 0; row < rows.size(); row++)
+    {
+        __output.append(std::get<0>(rows[row]), std::get<1>(rows[row]));
+        for (auto &result : results)
+        {
+            auto [end, err] = std::to_chars(number, number + sizeof(number), result[row]);
+            __output.push_back(',');
+            __output.append(number, end);
+        }
+        __output.push_back('\n');
+    }
+
+    return Rori::Math::ErrorKind::None;
+}
+
+auto Rori::Math::MathSolver::evaluate_csv(const std::string &__path, const std::vector<std::string> &__formulas, std::ostream &__out) -> Rori::Math::ErrorKind
+{
+    MappedFile file(__path);
+    if (!file.data())
+        return Rori::Math::ErrorKind::IoError;
+
+    const char *cursor = file.data(), *end = file.data() + file.size();
+    const char *header_end = line_end(cursor, end);
+
+    std::vector<std::string_view> fields;
+    split_fields(cursor, trim_line(cursor, header_end), fields);
+    std::vector<std::string> columns;
+    std::vector<std::size_t> bound;
+    for (std::size_t column = 0; column < fields.size(); column++)
+    {
+        if (!is_identifier(fields[column]))
+            continue;
+
+        columns.emplace_back(fields[column]);
+        bound.push_back(column);
+    }
+
+    std::vector<std::string> names;
+    std::vector<Expression> expressions;
+    for (auto &formula : __formulas)
+    {
+        std::size_t equal_sign = formula.find('=');
+        if (equal_sign == std::string::npos)
+            return Rori::Math::ErrorKind::SyntaxError;
+
+        std::string name = formula.substr(0, equal_sign);
+        name.erase(0, name.find_first_not_of(' '));
+        name.erase(name.find_last_not_of(' ') + 1);
+
+        auto [expression, err] = this->compile(formula.substr(equal_sign + 1), columns);
+        if (err != Rori::Math::ErrorKind::None)
+            return err;
+
+        // Reject array formula before anything is written, empty batch only check the shape
+        err = expression.evaluate_batch(nullptr, 0, nullptr);
+        if (err != Rori::Math::ErrorKind::None)
+            return err;
+
+        names.push_back(name);
+        expressions.push_back(expression);
+    }
+
+    __out.write(cursor, trim_line(cursor, header_end) - cursor);
+    for (auto &name : names)
+        __out << ',' << name;
+    __out << '\n';
+
+    cursor = header_end < end ? header_end + 1 : end;
+
+    // Every round hand one chunk per worker and write them back in order
+    std::size_t workers_size = worker_count(std::thread::hardware_concurrency());
+    std::vector<std::string> outputs(workers_size);
+    std::vector<Rori::Math::ErrorKind> errors(workers_size);
+    while (cursor < end)
+    {
+        std::vector<std::tuple<const char *, const char *>> chunks;
+        for (std::size_t worker = 0; worker < workers_size && cursor < end; worker++)
+        {
+            const char *chunk_end = cursor;
+            for (std::size_t row = 0; row < CHUNK_ROWS && chunk_end < end; row++)
+                chunk_end = line_end(chunk_end, end) + 1;
+
+            chunk_end = std::min(chunk_end, end);
+            chunks.push_back({cursor, chunk_end});
+            cursor = chunk_end;
+        }
+
+        run_workers(chunks.size(), [&](std::size_t chunk)
+                    { errors[chunk] = evaluate_chunk(std::get<0>(chunks[chunk]), std::get<1>(chunks[chunk]), bound, expressions, outputs[chunk]); });
+
+        for (std::size_t chunk = 0; chunk < chunks.size(); chunk++)
+        {
+            if (errors[chunk] != Rori::Math::ErrorKind::None)
+                return errors[chunk];
+
+            __out.write(outputs[chunk].data(), outputs[chunk].size());
+        }
+    }
+
+    __out.flush();
+
+    return __out ? Rori::Math::ErrorKind::None : Rori::Math::ErrorKind::IoError;
+}